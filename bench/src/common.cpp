@@ -0,0 +1,120 @@
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "batch_math.hpp"
+#include "metrics.hpp"
+#include "suite.hpp"
+#include "vector_math.hpp"
+
+namespace
+{
+    struct Vectors
+    {
+        std::vector<vec3> packed;
+        std::vector<float> x, y, z;
+    };
+
+    std::shared_ptr<Vectors> randomVectors(std::size_t count)
+    {
+        std::mt19937 random(static_cast<unsigned>(count));
+        std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+        auto vectors = std::make_shared<Vectors>();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            vec3 v(coordinate(random), coordinate(random), coordinate(random));
+            vectors->packed.push_back(v);
+            vectors->x.push_back(v.x);
+            vectors->y.push_back(v.y);
+            vectors->z.push_back(v.z);
+        }
+        return vectors;
+    }
+}
+
+void registerCommon(Suite &suite)
+{
+    for (std::size_t count: {1000, 100000})
+    {
+        auto vectors = randomVectors(count);
+        auto out = std::make_shared<Vectors>(*vectors);
+
+        suite.add("common/vec3::normalize", count, [vectors, out]
+        {
+            for (std::size_t i = 0; i < vectors->packed.size(); ++i)
+            {
+                out->packed[i] = vectors->packed[i].normalize();
+            }
+            keep(out->packed);
+        });
+        suite.add("common/vec3::fastNormalize", count, [vectors, out]
+        {
+            for (std::size_t i = 0; i < vectors->packed.size(); ++i)
+            {
+                out->packed[i] = vectors->packed[i].fastNormalize();
+            }
+            keep(out->packed);
+        });
+        suite.add("common/normalizeVectors", count, [vectors, out, count]
+        {
+            out->x = vectors->x;
+            out->y = vectors->y;
+            out->z = vectors->z;
+            normalizeVectors(out->x.data(), out->y.data(), out->z.data(), count);
+            keep(out->x);
+        });
+
+        mat3 rotation = mat3::rotationY(0.3f) * mat3::rotationX(1.2f);
+        suite.add("common/rotateVectors", count, [vectors, out, rotation, count]
+        {
+            rotateVectors(rotation, vectors->x.data(), vectors->y.data(), vectors->z.data(), count, out->x.data(), out->y.data(), out->z.data());
+            keep(out->x);
+        });
+        suite.add("common/dotProducts", count, [vectors, out, count]
+        {
+            dotProducts(vectors->x.data(), vectors->y.data(), vectors->z.data(), vectors->z.data(), vectors->x.data(), vectors->y.data(), count, out->x.data());
+            keep(out->x);
+        });
+
+        mat4 toScreen = mat4::projection(256.0f, 800, 600) * mat4::translation({0.0f, 0.0f, 50.0f}) * mat4::fromMat3(rotation);
+        suite.add("common/projectPoints", count, [vectors, out, toScreen, count]
+        {
+            projectPoints(toScreen, vectors->x.data(), vectors->y.data(), vectors->z.data(), count, out->x.data(), out->y.data(), out->z.data());
+            keep(out->x);
+        });
+    }
+
+    // What a frame loop pays per metric update; size is the number of updates.
+    auto metrics = std::make_shared<MetricRegistry>();
+    Counter &counter = metrics->counter("bench_total", "Counter updates.");
+    Histogram &histogram = metrics->histogram("bench_seconds", "Histogram updates.", Histogram::exponentialBounds(0.001, 2, 12));
+    suite.add("common/Counter::add", 1000, [metrics, &counter]
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            counter.add(i);
+        }
+        keep(counter);
+    });
+    suite.add("common/Histogram::observe", 1000, [metrics, &histogram]
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            histogram.observe(0.0001 * i);
+        }
+        keep(histogram);
+    });
+
+    // size is the number of products.
+    auto product = std::make_shared<mat4>(mat4::identity());
+    suite.add("common/mat4::operator*", 1000, [product]
+    {
+        mat4 step = mat4::rotationZ(0.001f) * mat4::translation({0.001f, 0.0f, 0.0f});
+        for (int i = 0; i < 1000; ++i)
+        {
+            *product = *product * step;
+        }
+        keep(*product);
+    });
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <istream>
+#include <iterator>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "suite.hpp"
+
+inline std::string quoted(const std::string &text)
+{
+    std::string result = "\"";
+    for (char c: text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+            result += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            result += escaped;
+        }
+        else
+        {
+            result += c;
+        }
+    }
+    return result + "\"";
+}
+
+inline std::string number(double value, int decimals = 1)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.*f", decimals, value);
+    return text;
+}
+
+// One benchmark per line, so results diff well:
+// {"context": {...}, "benchmarks": [{"name": ..., "size": ..., "runs": ..., "median_ns": ...,
+//  "min_ns": ..., "ns_per_item": ...[, "baseline_median_ns": ..., "ratio": ...], "status": ...}],
+//  "regressions": n}
+// status, the baseline fields and regressions only appear after compare().
+inline void writeResults(std::ostream &out, const std::map<std::string, std::string> &context, const std::vector<Measurement> &measurements, int regressions)
+{
+    out << "{\n  \"context\": {";
+    const char *separator = "";
+    for (const auto &entry: context)
+    {
+        out << separator << quoted(entry.first) << ": " << quoted(entry.second);
+        separator = ", ";
+    }
+    out << "},\n  \"benchmarks\": [\n";
+
+    bool compared = false;
+    for (std::size_t i = 0; i < measurements.size(); ++i)
+    {
+        const Measurement &m = measurements[i];
+        out << "    {\"name\": " << quoted(m.name) << ", \"size\": " << m.size << ", \"runs\": " << m.runs
+            << ", \"median_ns\": " << number(m.medianNanoseconds) << ", \"min_ns\": " << number(m.minNanoseconds)
+            << ", \"ns_per_item\": " << number(m.medianNanoseconds / std::max<std::size_t>(m.size, 1), 3);
+        if (m.baselineNanoseconds > 0.0)
+        {
+            out << ", \"baseline_median_ns\": " << number(m.baselineNanoseconds) << ", \"ratio\": " << number(m.medianNanoseconds / m.baselineNanoseconds, 3);
+        }
+        if (!m.status.empty())
+        {
+            out << ", \"status\": " << quoted(m.status);
+            compared = true;
+        }
+        out << "}" << (i + 1 < measurements.size() ? "," : "") << "\n";
+    }
+    out << "  ]";
+    if (compared)
+    {
+        out << ",\n  \"regressions\": " << regressions;
+    }
+    out << "\n}\n";
+}
+
+// Reads the benchmarks array back from writeResults output. Only the fields compare() needs
+// are kept, and every field value must be a string or a scalar, as writeResults emits them.
+class ResultsReader
+{
+public:
+    explicit ResultsReader(std::istream &in):
+        _text(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>())
+    {
+    }
+
+    std::vector<Measurement> read()
+    {
+        std::vector<Measurement> measurements;
+        std::size_t key = _text.find("\"benchmarks\"");
+        if (key == std::string::npos)
+        {
+            throw std::runtime_error("no \"benchmarks\" array in baseline");
+        }
+        _position = key + 12;
+        expect(':');
+        expect('[');
+        skipSpace();
+        if (peek() == ']')
+        {
+            return measurements;
+        }
+
+        while (true)
+        {
+            measurements.push_back(readMeasurement());
+            skipSpace();
+            if (peek() == ',')
+            {
+                ++_position;
+                continue;
+            }
+            expect(']');
+            return measurements;
+        }
+    }
+
+private:
+    std::string _text;
+    std::size_t _position = 0;
+
+    char peek() const
+    {
+        if (_position >= _text.size())
+        {
+            throw std::runtime_error("unexpected end of baseline");
+        }
+        return _text[_position];
+    }
+
+    void skipSpace()
+    {
+        while (_position < _text.size() && std::isspace(static_cast<unsigned char>(_text[_position])))
+        {
+            ++_position;
+        }
+    }
+
+    void expect(char c)
+    {
+        skipSpace();
+        if (peek() != c)
+        {
+            throw std::runtime_error(std::string("expected '") + c + "' in baseline at offset " + std::to_string(_position));
+        }
+        ++_position;
+    }
+
+    std::string readString()
+    {
+        expect('"');
+        std::string result;
+        while (peek() != '"')
+        {
+            char c = _text[_position++];
+            if (c == '\\')
+            {
+                c = peek();
+                ++_position;
+                if (c == 'u')
+                {
+                    result += static_cast<char>(std::strtol(_text.substr(_position, 4).c_str(), nullptr, 16));
+                    _position += 4;
+                    continue;
+                }
+                c = c == 'n' ? '\n' : c == 't' ? '\t' : c;
+            }
+            result += c;
+        }
+        ++_position;
+        return result;
+    }
+
+    // Numbers, true, false and null, returned as text.
+    std::string readScalar()
+    {
+        skipSpace();
+        std::size_t start = _position;
+        while (_position < _text.size() && _text[_position] != ',' && _text[_position] != '}' && _text[_position] != ']' &&
+               !std::isspace(static_cast<unsigned char>(_text[_position])))
+        {
+            ++_position;
+        }
+        return _text.substr(start, _position - start);
+    }
+
+    Measurement readMeasurement()
+    {
+        Measurement measurement;
+        expect('{');
+        skipSpace();
+        while (peek() != '}')
+        {
+            std::string name = readString();
+            expect(':');
+            skipSpace();
+            std::string value = peek() == '"' ? readString() : readScalar();
+
+            if (name == "name")
+            {
+                measurement.name = value;
+            }
+            else if (name == "size")
+            {
+                measurement.size = std::strtoull(value.c_str(), nullptr, 10);
+            }
+            else if (name == "runs")
+            {
+                measurement.runs = std::atoi(value.c_str());
+            }
+            else if (name == "median_ns")
+            {
+                measurement.medianNanoseconds = std::strtod(value.c_str(), nullptr);
+            }
+            else if (name == "min_ns")
+            {
+                measurement.minNanoseconds = std::strtod(value.c_str(), nullptr);
+            }
+
+            skipSpace();
+            if (peek() == ',')
+            {
+                ++_position;
+                skipSpace();
+            }
+        }
+        ++_position;
+        return measurement;
+    }
+};
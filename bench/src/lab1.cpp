@@ -0,0 +1,105 @@
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "suite.hpp"
+#include "../../lab1/src/bezier.hpp"
+#include "../../lab1/src/curve_batch.hpp"
+#include "../../lab1/src/curve_picking.hpp"
+
+namespace
+{
+    const point_array<4> LAB1_CUBIC = {{{-0.8f, -0.5f}, {-0.2f, 0.8f}, {0.2f, -0.8f}, {0.8f, 0.5f}}};
+
+    std::vector<float> randomCoordinates(std::size_t count, unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+        std::vector<float> coordinates(count);
+        for (auto &value: coordinates)
+        {
+            value = coordinate(random);
+        }
+        return coordinates;
+    }
+}
+
+void registerLab1(Suite &suite)
+{
+    for (std::size_t points: {100, 1000, 10000})
+    {
+        auto curve = std::make_shared<BezierCurve<3>>(LAB1_CUBIC);
+        auto out = std::make_shared<std::vector<point>>(points);
+
+        // evaluateBezier's successor, once per point.
+        suite.add("lab1/BezierCurve::evaluate", points, [curve, out, points]
+        {
+            for (std::size_t i = 0; i < points; ++i)
+            {
+                (*out)[i] = curve->evaluate(static_cast<float>(i) / (points - 1));
+            }
+            keep(*out);
+        });
+        // computeBezierCurvePoints' successor.
+        suite.add("lab1/BezierCurve::sample", points, [curve, out, points]
+        {
+            curve->sample(out->data(), points);
+            keep(*out);
+        });
+    }
+
+    // size is the window width in pixels; the vertex count grows with it.
+    for (std::size_t width: {800, 3200})
+    {
+        auto curve = std::make_shared<BezierCurve<3>>(LAB1_CUBIC);
+        auto out = std::make_shared<std::vector<point>>();
+        point scale = {width * 0.5f, width * 0.375f};
+        suite.add("lab1/BezierCurve::flatten", width, [curve, out, scale]
+        {
+            curve->flatten(0.25f, scale, *out);
+            keep(*out);
+        });
+    }
+
+    for (std::size_t curves: {1000, 100000})
+    {
+        auto x = std::make_shared<std::vector<float>>(randomCoordinates(4 * curves, 1));
+        auto y = std::make_shared<std::vector<float>>(randomCoordinates(4 * curves, 2));
+        auto outX = std::make_shared<std::vector<float>>(curves);
+        auto outY = std::make_shared<std::vector<float>>(curves);
+        auto evaluator = std::make_shared<BatchEvaluator>(SegmentBasis::Bezier, 3);
+        suite.add("lab1/BatchEvaluator::evaluate", curves, [x, y, outX, outY, evaluator, curves]
+        {
+            evaluator->evaluate({curves, x->data(), y->data()}, 0.5f, outX->data(), outY->data());
+            keep(*outX);
+            keep(*outY);
+        });
+    }
+
+    // size is the number of curves searched by each of 100 queries.
+    for (std::size_t curves: {1, 1000})
+    {
+        auto picker = std::make_shared<CurvePicker>();
+        std::vector<float> centres = randomCoordinates(2 * curves, 3);
+        std::vector<float> offsets = randomCoordinates(8 * curves, 4);
+        for (std::size_t c = 0; c < curves; ++c)
+        {
+            point_array<4> controlPoints;
+            for (std::size_t k = 0; k < 4; ++k)
+            {
+                controlPoints[k] = {centres[2 * c] + 0.15f * offsets[8 * c + 2 * k], centres[2 * c + 1] + 0.15f * offsets[8 * c + 2 * k + 1]};
+            }
+            picker->add(BezierCurve<3>(controlPoints), {400.0f, 300.0f});
+        }
+        auto queries = std::make_shared<std::vector<float>>(randomCoordinates(200, 5));
+        suite.add("lab1/CurvePicker::closest", curves, [picker, queries]
+        {
+            for (std::size_t q = 0; q < 100; ++q)
+            {
+                CurveHit hit = picker->closest({(*queries)[2 * q] * 400.0f, (*queries)[2 * q + 1] * 300.0f});
+                keep(hit);
+            }
+        });
+    }
+}
@@ -0,0 +1,107 @@
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "frame_arena.hpp"
+#include "suite.hpp"
+#include "../../lab2/src/cube.hpp"
+
+namespace
+{
+    // Cube::draw's shading, before LightSet: normal from three rotated vertices with a
+    // sqrt, one scalar dot product per light.
+    sf::Vector3f calculateNormal(const sf::Vector3f &v1, const sf::Vector3f &v2, const sf::Vector3f &v3)
+    {
+        sf::Vector3f edge1 = v2 - v1;
+        sf::Vector3f edge2 = v3 - v1;
+        sf::Vector3f normal(edge1.y * edge2.z - edge1.z * edge2.y, edge1.z * edge2.x - edge1.x * edge2.z, edge1.x * edge2.y - edge1.y * edge2.x);
+        return normal / std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+    }
+
+    LightSet randomLights(std::size_t count)
+    {
+        std::mt19937 random(static_cast<unsigned>(count));
+        std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+        LightSet lights;
+        for (std::size_t l = 0; l < count; ++l)
+        {
+            lights.add({coordinate(random), coordinate(random), coordinate(random)}, {0.5f, 0.5f, 0.5f});
+        }
+        return lights;
+    }
+}
+
+void registerLab2(Suite &suite)
+{
+    for (std::size_t cubes: {1000, 10000})
+    {
+        auto cube = std::make_shared<Cube>(100.0f, sf::Vector3f(0.0f, 0.0f, 5.0f), 800, 600);
+        auto normals = std::make_shared<FaceNormals>();
+        suite.add("lab2/Cube::rotateNormals", cubes, [cube, normals, cubes]
+        {
+            normals->clear();
+            for (std::size_t c = 0; c < cubes; ++c)
+            {
+                cube->rotateNormals(0.001f * c, 0.002f * c, *normals);
+            }
+            keep(*normals);
+        });
+
+        // size is the number of triangles.
+        auto triangles = std::make_shared<std::vector<sf::Vector3f>>();
+        for (std::size_t i = 0; i < 3 * cubes; ++i)
+        {
+            float angle = 0.01f * i;
+            triangles->push_back({100.0f * std::cos(angle), 100.0f * std::sin(angle), static_cast<float>(i % 7)});
+        }
+        auto out = std::make_shared<std::vector<sf::Vector3f>>(cubes);
+        suite.add("lab2/calculateNormal", cubes, [triangles, out, cubes]
+        {
+            for (std::size_t i = 0; i < cubes; ++i)
+            {
+                (*out)[i] = calculateNormal((*triangles)[3 * i], (*triangles)[3 * i + 1], (*triangles)[3 * i + 2]);
+            }
+            keep(*out);
+        });
+
+        // One frame of cubes' quads, built into a FrameArena as Cube::draw does.
+        auto arena = std::make_shared<FrameArena>();
+        auto lights = std::make_shared<LightSet>(randomLights(2));
+        suite.add("lab2/Cube::buildQuads", cubes, [cube, arena, lights, cubes]
+        {
+            arena->reset();
+            FrameVector<sf::Vertex> quads(*arena);
+            quads.reserve(cubes * cube->faceCount() * 4);
+            for (std::size_t c = 0; c < cubes; ++c)
+            {
+                cube->buildQuads(0.001f * c, 0.002f * c, *lights, *arena, quads);
+            }
+            keep(quads.size());
+        });
+    }
+
+    // size is the number of faces.
+    for (std::size_t lightCount: {2, 64})
+    {
+        for (std::size_t faces: {6000, 60000})
+        {
+            auto lights = std::make_shared<LightSet>(randomLights(lightCount));
+            auto normals = std::make_shared<FaceNormals>();
+            Cube cube(100.0f, {0.0f, 0.0f, 5.0f}, 800, 600);
+            for (std::size_t c = 0; c < faces / cube.faceCount(); ++c)
+            {
+                cube.rotateNormals(0.001f * c, 0.002f * c, *normals);
+            }
+            auto colors = std::make_shared<FaceColors>();
+            suite.add("lab2/LightSet::shade/" + std::to_string(lightCount) + " lights", faces, [lights, normals, colors]
+            {
+                lights->shade(*normals, *colors);
+                keep(*colors);
+            });
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "suite.hpp"
+#include "../../lab3/src/cube.hpp"
+#include "../../lab3/src/cube_field.hpp"
+#include "../../lab3/src/view.hpp"
+
+namespace
+{
+    // Partway down lab3's middle camera path.
+    const sf::Vector3f CAMERA_POSITION = {150.0f, 0.0f, 20000.0f};
+
+    struct Field
+    {
+        std::vector<CubeInstance> cubes;
+        CubeGrid grid;
+        std::vector<std::uint32_t> visible;
+    };
+}
+
+void registerLab3(Suite &suite)
+{
+    ViewFrustum frustum(CAMERA_POSITION, 800, 600);
+
+    // size is the number of cubes in the field.
+    for (std::size_t cubes: {10000, 100000})
+    {
+        auto field = std::make_shared<Field>();
+        field->cubes = generateCubeField(cubes, {{-2000.0f, -1000.0f, 100.0f}, {2000.0f, 1000.0f, 40000.0f}}, 10.0f, 30.0f, 3);
+        field->grid.build(field->cubes, 250.0f);
+
+        suite.add("lab3/CubeGrid::build", cubes, [field]
+        {
+            CubeGrid grid;
+            grid.build(field->cubes, 250.0f);
+            keep(grid);
+        });
+        suite.add("lab3/CubeGrid::query", cubes, [field, frustum]
+        {
+            field->visible.clear();
+            std::size_t cells = field->grid.query(field->cubes, frustum, field->visible);
+            keep(cells);
+        });
+
+        field->visible.clear();
+        field->grid.query(field->cubes, frustum, field->visible);
+        auto cube = std::make_shared<CubeMesh>();
+        auto triangles = std::make_shared<sf::VertexArray>(sf::Triangles);
+        // Rotates, culls, clips and projects every visible cube, as lab3 does for a frame.
+        suite.add("lab3/CubeMesh::append", cubes, [field, frustum, cube, triangles]
+        {
+            FieldStats stats;
+            triangles->clear();
+            for (auto index: field->visible)
+            {
+                cube->append(field->cubes[index], 0.3f, 0.5f, frustum, *triangles, stats);
+            }
+            keep(stats);
+        });
+    }
+
+    // size is the number of quads, half of them crossing the near plane.
+    for (std::size_t quads: {1000, 100000})
+    {
+        auto polygons = std::make_shared<std::vector<std::array<sf::Vector3f, 4>>>();
+        for (std::size_t i = 0; i < quads; ++i)
+        {
+            float z = i % 2 == 0 ? -FOV - 10.0f : 100.0f;
+            polygons->push_back({{{-10.0f, -10.0f, z}, {10.0f, -10.0f, z}, {10.0f, 10.0f, 50.0f}, {-10.0f, 10.0f, 50.0f}}});
+        }
+        suite.add("lab3/ViewFrustum::clipNear", quads, [polygons, frustum]
+        {
+            std::size_t vertices = 0;
+            sf::Vector3f clipped[MAX_CLIPPED_VERTICES];
+            for (const auto &polygon: *polygons)
+            {
+                vertices += frustum.clipNear(polygon.data(), polygon.size(), clipped);
+            }
+            keep(vertices);
+        });
+    }
+}
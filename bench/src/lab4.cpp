@@ -0,0 +1,82 @@
+#include <SFML/System/Vector3.hpp>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "suite.hpp"
+#include "../../lab4/src/lighting.hpp"
+#include "../../lab4/src/systems.hpp"
+#include "../../lab4/src/transform.hpp"
+
+namespace
+{
+    VertexStream randomVertices(std::size_t count, unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+        VertexStream vertices;
+        vertices.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            vertices.x[i] = coordinate(random);
+            vertices.y[i] = coordinate(random);
+            vertices.z[i] = coordinate(random);
+        }
+        return vertices;
+    }
+}
+
+void registerLab4(Suite &suite)
+{
+    Matrix4 model = Matrix4::translation({0.0f, 0.0f, 400.0f}) * Matrix4::rotationY(0.5f) * Matrix4::rotationX(0.3f);
+    Matrix4 viewProjection = Matrix4::projection(FOV, 800, 600) * model;
+
+    for (std::size_t vertices: {1000, 100000})
+    {
+        auto in = std::make_shared<VertexStream>(randomVertices(vertices, 1));
+        auto out = std::make_shared<VertexStream>();
+        // The batch successors of rotateVertices and projectVertices.
+        suite.add("lab4/transformPoints", vertices, [in, out, model]
+        {
+            transformPoints(model, *in, *out);
+            keep(*out);
+        });
+        suite.add("lab4/projectPoints", vertices, [in, out, viewProjection]
+        {
+            projectPoints(viewProjection, *in, *out);
+            keep(*out);
+        });
+
+        // size is the number of triangles.
+        auto normals = std::make_shared<std::vector<sf::Vector3f>>(vertices / 3);
+        suite.add("lab4/calculateNormal", vertices / 3, [in, normals]
+        {
+            for (std::size_t i = 0; i < normals->size(); ++i)
+            {
+                (*normals)[i] = calculateNormal((*in)[3 * i], (*in)[3 * i + 1], (*in)[3 * i + 2]);
+            }
+            keep(*normals);
+        });
+    }
+
+    // size is the number of lights.
+    for (std::size_t lightCount: {64, 1024})
+    {
+        std::mt19937 random(static_cast<unsigned>(lightCount));
+        std::uniform_real_distribution<float> coordinate(-1000.0f, 1000.0f);
+        std::uniform_real_distribution<float> depth(0.0f, 3000.0f);
+        auto lights = std::make_shared<std::vector<PointLight>>(lightCount);
+        for (auto &light: *lights)
+        {
+            light.position = {coordinate(random), coordinate(random), depth(random)};
+            light.range = 150.0f;
+        }
+        auto clusters = std::make_shared<LightClusters>();
+        suite.add("lab4/LightClusters::build", lightCount, [lights, clusters]
+        {
+            clusters->build(*lights, {0.0f, 0.0f, 0.0f}, 800, 600, 1.0f);
+            keep(*clusters);
+        });
+    }
+}
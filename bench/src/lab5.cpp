@@ -0,0 +1,77 @@
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "suite.hpp"
+#include "../../lab5/src/raytracer.hpp"
+
+namespace
+{
+    std::vector<Sphere> labSpheres()
+    {
+        return {
+            Sphere(Vec3(-1, 0, -5), 1, Vec3(1, 0, 0)),
+            Sphere(Vec3(1, 0, -5), 1, Vec3(0, 1, 0)),
+            Sphere(Vec3(0, -1, -5), 1, Vec3(0, 0, 1))
+        };
+    }
+
+    // Primary ray directions across the lab5 image, one per ray.
+    std::vector<Vec3> rayDirections(std::size_t count)
+    {
+        std::vector<Vec3> directions;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            float u = static_cast<float>(i % WIDTH) / WIDTH;
+            float v = static_cast<float>(i * 7 % HEIGHT) / HEIGHT;
+            directions.push_back(Vec3(u - 0.5f, v - 0.5f, -1).normalize());
+        }
+        return directions;
+    }
+}
+
+void registerLab5(Suite &suite)
+{
+    auto spheres = std::make_shared<std::vector<Sphere>>(labSpheres());
+    auto lights = std::make_shared<std::vector<Light>>(std::vector<Light>{Light(Vec3(0, 5, 0), Vec3(1, 1, 1))});
+
+    for (std::size_t rays: {1000, 100000})
+    {
+        auto directions = std::make_shared<std::vector<Vec3>>(rayDirections(rays));
+        suite.add("lab5/intersectSphere", rays, [directions, spheres]
+        {
+            int hits = 0;
+            for (const auto &direction: *directions)
+            {
+                float t;
+                hits += intersectSphere(Vec3(0, 0, 0), direction, (*spheres)[0], t);
+            }
+            keep(hits);
+        });
+        suite.add("lab5/traceRay", rays, [directions, spheres, lights]
+        {
+            Vec3 sum;
+            for (const auto &direction: *directions)
+            {
+                sum = sum + traceRay(Vec3(0, 0, 0), direction, *spheres, *lights);
+            }
+            keep(sum);
+        });
+    }
+
+    // size is the number of depth-of-field samples per pixel of the 800x600 image.
+    for (int samples: {1, 4})
+    {
+        auto image = std::make_shared<sf::Image>();
+        image->create(WIDTH, HEIGHT, sf::Color::Black);
+        Camera camera(Vec3(0, 0, 0), Vec3(0, 0, -1), 0.1f, 5.0f, samples);
+        suite.add("lab5/renderScene", samples, [image, spheres, lights, camera]
+        {
+            std::srand(1);
+            renderScene(*image, *spheres, *lights, camera);
+            keep(*image);
+        });
+    }
+}
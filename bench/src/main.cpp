@@ -0,0 +1,153 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "json.hpp"
+#include "suite.hpp"
+
+void registerCommon(Suite &suite);
+void registerLab1(Suite &suite);
+void registerLab2(Suite &suite);
+void registerLab3(Suite &suite);
+void registerLab4(Suite &suite);
+void registerLab5(Suite &suite);
+
+namespace
+{
+    const char *USAGE =
+        "usage: graphics_bench [--filter TEXT] [--output FILE] [--compare BASELINE] [--threshold FRACTION]\n"
+        "  --filter TEXT         run only benchmarks whose name contains TEXT, e.g. common/, lab3/ or ::shade\n"
+        "  --output FILE         write the JSON results to FILE instead of standard output\n"
+        "  --compare BASELINE    compare medians with an earlier --output file and exit with 1 on regressions\n"
+        "  --threshold FRACTION  slowdown that counts as a regression (default 0.10)\n";
+
+    std::map<std::string, std::string> buildContext()
+    {
+        std::map<std::string, std::string> context;
+#if defined(__VERSION__)
+        context["compiler"] = __VERSION__;
+#endif
+#if defined(__AVX2__)
+        context["simd"] = "AVX2";
+#elif defined(__AVX__)
+        context["simd"] = "AVX";
+#elif defined(__SSE2__) || defined(_M_X64)
+        context["simd"] = "SSE2";
+#else
+        context["simd"] = "none";
+#endif
+#if defined(NDEBUG)
+        context["build"] = "release";
+#else
+        context["build"] = "debug";
+#endif
+        context["threads"] = std::to_string(std::thread::hardware_concurrency());
+        return context;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::string filter, output, baselinePath;
+    double threshold = DEFAULT_REGRESSION_THRESHOLD;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--filter") == 0 && hasValue)
+        {
+            filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--output") == 0 && hasValue)
+        {
+            output = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--compare") == 0 && hasValue)
+        {
+            baselinePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--threshold") == 0 && hasValue)
+        {
+            const char *text = argv[++i];
+            char *end = nullptr;
+            threshold = std::strtod(text, &end);
+            if (end == text || *end != '\0' || !(threshold >= 0.0))
+            {
+                std::cerr << "--threshold needs a fraction of 0 or more, not " << text << "\n" << USAGE;
+                return 2;
+            }
+        }
+        else
+        {
+            std::cerr << USAGE;
+            return 2;
+        }
+    }
+
+    // Read the baseline first, so a bad path fails before the suite runs.
+    std::vector<Measurement> baseline;
+    if (!baselinePath.empty())
+    {
+        std::ifstream in(baselinePath);
+        if (!in)
+        {
+            std::cerr << "cannot open baseline " << baselinePath << "\n";
+            return 2;
+        }
+        try
+        {
+            baseline = ResultsReader(in).read();
+        }
+        catch (const std::exception &error)
+        {
+            std::cerr << baselinePath << ": " << error.what() << "\n";
+            return 2;
+        }
+    }
+
+    Suite suite;
+    registerCommon(suite);
+    registerLab1(suite);
+    registerLab2(suite);
+    registerLab3(suite);
+    registerLab4(suite);
+    registerLab5(suite);
+
+    std::vector<Measurement> measurements = suite.run(filter, std::cerr);
+
+    int regressions = 0;
+    if (!baselinePath.empty())
+    {
+        regressions = compare(measurements, baseline, threshold);
+        for (const auto &measurement: measurements)
+        {
+            if (measurement.status == "regression" || measurement.status == "improvement")
+            {
+                std::cerr << measurement.status << ": " << measurement.name << " [" << measurement.size << "] "
+                          << measurement.baselineNanoseconds / 1e3 << " us -> " << measurement.medianNanoseconds / 1e3 << " us\n";
+            }
+        }
+        std::cerr << regressions << " regression(s) beyond " << threshold * 100.0 << "%\n";
+    }
+
+    if (output.empty())
+    {
+        writeResults(std::cout, buildContext(), measurements, regressions);
+    }
+    else
+    {
+        std::ofstream out(output);
+        writeResults(out, buildContext(), measurements, regressions);
+        if (!out)
+        {
+            std::cerr << "cannot write " << output << "\n";
+            return 2;
+        }
+    }
+
+    return regressions > 0 ? 1 : 0;
+}
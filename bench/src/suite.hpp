@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Every benchmark runs at least MIN_RUNS times and until it has taken MIN_SECONDS, up to
+// MAX_RUNS runs, after one untimed warm-up run.
+constexpr int MIN_RUNS = 5;
+constexpr int MAX_RUNS = 1000;
+constexpr double MIN_SECONDS = 0.2;
+
+// A median more than this fraction above its baseline is flagged as a regression.
+constexpr double DEFAULT_REGRESSION_THRESHOLD = 0.10;
+
+// Keeps the compiler from discarding a result the benchmark never reads.
+template<typename T>
+inline void keep(const T &value) noexcept
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+struct Measurement
+{
+    std::string name;
+    std::size_t size = 0;
+    int runs = 0;
+    double medianNanoseconds = 0.0;
+    double minNanoseconds = 0.0;
+
+    // Filled in by compare().
+    double baselineNanoseconds = 0.0;
+    std::string status;
+};
+
+// Named benchmarks, each registered once per input size. name is "lab/kernel" and size is
+// the number of items the kernel handles per run, so results report time per item too.
+class Suite
+{
+public:
+    void add(const std::string &name, std::size_t size, std::function<void()> run)
+    {
+        _benchmarks.push_back({name, size, std::move(run)});
+    }
+
+    // Runs the benchmarks whose name contains filter, logging progress to log.
+    std::vector<Measurement> run(const std::string &filter, std::ostream &log) const
+    {
+        std::vector<Measurement> measurements;
+        for (const auto &benchmark: _benchmarks)
+        {
+            if (benchmark.name.find(filter) == std::string::npos)
+            {
+                continue;
+            }
+
+            benchmark.run();
+            std::vector<double> times;
+            double total = 0.0;
+            while (times.size() < static_cast<std::size_t>(MAX_RUNS) && (times.size() < static_cast<std::size_t>(MIN_RUNS) || total < MIN_SECONDS * 1e9))
+            {
+                auto start = std::chrono::steady_clock::now();
+                benchmark.run();
+                double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                times.push_back(elapsed);
+                total += elapsed;
+            }
+            std::sort(times.begin(), times.end());
+
+            Measurement measurement;
+            measurement.name = benchmark.name;
+            measurement.size = benchmark.size;
+            measurement.runs = static_cast<int>(times.size());
+            measurement.medianNanoseconds = times[times.size() / 2];
+            measurement.minNanoseconds = times.front();
+            measurements.push_back(measurement);
+
+            log << benchmark.name << " [" << benchmark.size << "]: " << measurement.medianNanoseconds / 1e3 << " us median over "
+                << measurement.runs << " runs\n";
+        }
+        return measurements;
+    }
+
+private:
+    struct Benchmark
+    {
+        std::string name;
+        std::size_t size;
+        std::function<void()> run;
+    };
+
+    std::vector<Benchmark> _benchmarks;
+};
+
+// Marks each measurement against the baseline median of the same name and size:
+// "regression", "improvement", "unchanged", or "new" when the baseline lacks it.
+// Returns the number of regressions.
+inline int compare(std::vector<Measurement> &measurements, const std::vector<Measurement> &baseline, double threshold)
+{
+    std::map<std::pair<std::string, std::size_t>, double> medians;
+    for (const auto &measurement: baseline)
+    {
+        medians[{measurement.name, measurement.size}] = measurement.medianNanoseconds;
+    }
+
+    int regressions = 0;
+    for (auto &measurement: measurements)
+    {
+        auto found = medians.find({measurement.name, measurement.size});
+        if (found == medians.end() || found->second <= 0.0)
+        {
+            measurement.status = "new";
+            continue;
+        }
+
+        measurement.baselineNanoseconds = found->second;
+        double ratio = measurement.medianNanoseconds / found->second;
+        if (ratio > 1.0 + threshold)
+        {
+            measurement.status = "regression";
+            ++regressions;
+        }
+        else if (ratio < 1.0 - threshold)
+        {
+            measurement.status = "improvement";
+        }
+        else
+        {
+            measurement.status = "unchanged";
+        }
+    }
+    return regressions;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Heap allocations made through operator new by every thread of the program. The counts
+// only move in programs that include allocation_hooks.hpp in one source file; elsewhere
+// they stay zero.
+struct HeapCounts
+{
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+
+    static std::atomic<std::uint64_t> &allocationCounter() noexcept
+    {
+        static std::atomic<std::uint64_t> counter{0};
+        return counter;
+    }
+
+    static std::atomic<std::uint64_t> &byteCounter() noexcept
+    {
+        static std::atomic<std::uint64_t> counter{0};
+        return counter;
+    }
+
+    static void record(std::size_t size) noexcept
+    {
+        allocationCounter().fetch_add(1, std::memory_order_relaxed);
+        byteCounter().fetch_add(size, std::memory_order_relaxed);
+    }
+
+    static HeapCounts now() noexcept
+    {
+        HeapCounts counts;
+        counts.allocations = allocationCounter().load(std::memory_order_relaxed);
+        counts.bytes = byteCounter().load(std::memory_order_relaxed);
+        return counts;
+    }
+
+    HeapCounts operator-(const HeapCounts &earlier) const noexcept
+    {
+        HeapCounts difference;
+        difference.allocations = allocations - earlier.allocations;
+        difference.bytes = bytes - earlier.bytes;
+        return difference;
+    }
+};
+
+// Heap traffic per frame of a frame loop: beginFrame() at the top of the loop, endFrame()
+// after display(). Keeps the worst and total counts until take() hands them over, so a
+// title bar refreshed once a second can show them without its own strings being counted.
+class FrameHeapMeter
+{
+public:
+    struct Summary
+    {
+        std::uint64_t frames = 0;
+        std::uint64_t maxAllocations = 0;
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    void beginFrame() noexcept
+    {
+        _start = HeapCounts::now();
+    }
+
+    void endFrame() noexcept
+    {
+        HeapCounts frame = HeapCounts::now() - _start;
+        ++_summary.frames;
+        _summary.maxAllocations = std::max(_summary.maxAllocations, frame.allocations);
+        _summary.allocations += frame.allocations;
+        _summary.bytes += frame.bytes;
+    }
+
+    Summary take() noexcept
+    {
+        Summary summary = _summary;
+        _summary = Summary();
+        return summary;
+    }
+
+private:
+    HeapCounts _start;
+    Summary _summary;
+};
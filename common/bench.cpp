@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "batch_math.hpp"
+#include "bench_timing.hpp"
+#include "vector_math.hpp"
+
+namespace
+{
+    constexpr int SCREEN_WIDTH = 800;
+    constexpr int SCREEN_HEIGHT = 600;
+    constexpr float FOV = 256.0f;
+
+    // Largest differences each check allows. The transform ones are two float steps at the
+    // size of the values compared: coordinates below 256, pixels below 512.
+    constexpr float ROTATION_TOLERANCE = 3.1e-5f;
+    constexpr float PROJECTION_TOLERANCE = 6.2e-5f;
+    // projectPoints multiplies by 1 / w where projectPoint divides, so up to four steps.
+    constexpr float BATCH_PROJECTION_TOLERANCE = 1.3e-4f;
+    // Two float steps at 1. fastNormalize multiplies by 1 / sqrt where sqrt + divide divides,
+    // and normalizeVectors refines its estimate with one Newton-Raphson step.
+    constexpr float NORMALIZE_TOLERANCE = 2.4e-7f;
+    // The batch kernels sum in the scalar order, but a compiler may contract to FMA.
+    constexpr float DOT_TOLERANCE = 1e-6f;
+    constexpr float ROTATE_TOLERANCE = 1e-6f;
+    // Points up to 17 units from the origin, where a float step is 1.9e-6.
+    constexpr float QUATERNION_AXIS_TOLERANCE = 1e-5f;
+    constexpr float QUATERNION_MATRIX_TOLERANCE = 2e-6f;
+
+    int failures = 0;
+
+    // Counts a failure, and names it, when error is above tolerance.
+    void expectWithin(const char *check, float error, float tolerance)
+    {
+        if (!(error <= tolerance))
+        {
+            std::printf("FAILED %s: %.2e is above the %.2e tolerance\n", check, error, tolerance);
+            ++failures;
+        }
+    }
+
+    static_assert(mat4::translation(vec3(1.0f, 2.0f, 3.0f)).transformPoint(vec3()).z == 3.0f, "mat4 is usable in constant expressions");
+    static_assert(cross(vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f)).z == 1.0f, "vec3 is usable in constant expressions");
+
+    // The math the labs wrote out by hand before the shared types.
+    namespace legacy
+    {
+        vec3 rotate(const vec3 &vertex, float angleX, float angleY)
+        {
+            float cosX = std::cos(angleX);
+            float sinX = std::sin(angleX);
+            float cosY = std::cos(angleY);
+            float sinY = std::sin(angleY);
+
+            float y1 = vertex.y * cosX - vertex.z * sinX;
+            float z1 = vertex.y * sinX + vertex.z * cosX;
+            return {vertex.x * cosY + z1 * sinY, y1, -vertex.x * sinY + z1 * cosY};
+        }
+
+        vec2 project(const vec3 &vertex, const vec3 &position)
+        {
+            float aspectRatio = static_cast<float>(SCREEN_WIDTH) / SCREEN_HEIGHT;
+            float x = vertex.x + position.x;
+            float y = vertex.y + position.y;
+            float z = vertex.z + position.z;
+
+            float zInv = 1.0f / (z + FOV);
+            return {x * zInv * FOV * aspectRatio + SCREEN_WIDTH / 2, y * zInv * FOV + SCREEN_HEIGHT / 2};
+        }
+
+        vec3 normalize(const vec3 &v)
+        {
+            float length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+            return {v.x / length, v.y / length, v.z / length};
+        }
+
+        // lab4's Matrix4::operator*.
+        mat4 multiply(const mat4 &a, const mat4 &b)
+        {
+            mat4 result;
+            for (int row = 0; row < 4; ++row)
+            {
+                for (int col = 0; col < 4; ++col)
+                {
+                    float sum = 0.0f;
+                    for (int k = 0; k < 4; ++k)
+                    {
+                        sum += a.m[row * 4 + k] * b.m[k * 4 + col];
+                    }
+                    result.m[row * 4 + col] = sum;
+                }
+            }
+            return result;
+        }
+    }
+
+    float largestDifference(const vec3 &a, const vec3 &b)
+    {
+        return std::max({std::abs(a.x - b.x), std::abs(a.y - b.y), std::abs(a.z - b.z)});
+    }
+
+    std::vector<vec3> randomVectors(std::size_t count, float scale)
+    {
+        std::mt19937 random(44);
+        std::uniform_real_distribution<float> coordinate(-scale, scale);
+        std::vector<vec3> vectors(count);
+        for (auto &v: vectors)
+        {
+            v = {coordinate(random), coordinate(random), coordinate(random)};
+        }
+        return vectors;
+    }
+
+    // mat3/mat4 against the per-vertex rotate-then-project code of lab2 and lab4.
+    void checkTransforms(std::size_t count)
+    {
+        std::vector<vec3> vertices = randomVectors(count, 100.0f);
+        vec3 position = {0.0f, 0.0f, 500.0f};
+        float rotationError = 0.0f, screenError = 0.0f, batchError = 0.0f;
+
+        std::vector<float> x(count), y(count), z(count), outX(count), outY(count), outZ(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            x[i] = vertices[i].x;
+            y[i] = vertices[i].y;
+            z[i] = vertices[i].z;
+        }
+
+        for (int step = 0; step < 16; ++step)
+        {
+            float angleX = 0.37f * step, angleY = -0.23f * step;
+            mat3 rotation = mat3::rotationY(angleY) * mat3::rotationX(angleX);
+            mat4 toScreen = mat4::projection(FOV, SCREEN_WIDTH, SCREEN_HEIGHT) * mat4::translation(position) * mat4::fromMat3(rotation);
+            projectPoints(toScreen, x.data(), y.data(), z.data(), count, outX.data(), outY.data(), outZ.data());
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                vec3 expected = legacy::rotate(vertices[i], angleX, angleY);
+                vec2 expectedScreen = legacy::project(expected, position);
+                vec3 projected = toScreen.projectPoint(vertices[i]);
+
+                rotationError = std::max(rotationError, largestDifference(rotation * vertices[i], expected));
+                screenError = std::max({screenError, std::abs(projected.x - expectedScreen.x), std::abs(projected.y - expectedScreen.y)});
+                batchError = std::max(batchError, largestDifference(vec3(outX[i], outY[i], outZ[i]), projected));
+            }
+        }
+
+        std::printf("transform %zu vertices x 16 poses: mat3 vs cos/sin rotation %.2e, mat4 projection vs lab projection %.2e px, "
+                    "projectPoints vs projectPoint %.2e\n", count, rotationError, screenError, batchError);
+        expectWithin("mat3 rotation", rotationError, ROTATION_TOLERANCE);
+        expectWithin("mat4 projection", screenError, PROJECTION_TOLERANCE);
+        expectWithin("projectPoints", batchError, BATCH_PROJECTION_TOLERANCE);
+    }
+
+    // mat4's product is the loop lab4 used, so the bits must match.
+    void checkMatrixProduct()
+    {
+        std::vector<vec3> values = randomVectors(64, 10.0f);
+        int mismatches = 0;
+        for (std::size_t i = 0; i + 1 < values.size(); ++i)
+        {
+            mat4 a = mat4::translation(values[i]) * mat4::rotationX(values[i].x) * mat4::projection(values[i + 1].z + 20.0f, SCREEN_WIDTH, SCREEN_HEIGHT);
+            mat4 b = mat4::rotationY(values[i + 1].y) * mat4::translation(values[i + 1]);
+            mat4 product = a * b;
+            mat4 scalar = legacy::multiply(a, b);
+            mismatches += std::memcmp(product.m, scalar.m, sizeof(product.m)) != 0;
+        }
+
+        mat4 a = mat4::rotationZ(0.5f) * mat4::translation({1.0f, 2.0f, 3.0f});
+        mat4 b = mat4::rotationX(-0.3f);
+        double productTime = measureNanoseconds([&]
+        {
+            for (int i = 0; i < 100000; ++i)
+            {
+                a = a * b;
+            }
+        }, 5);
+        double scalarTime = measureNanoseconds([&]
+        {
+            for (int i = 0; i < 100000; ++i)
+            {
+                a = legacy::multiply(a, b);
+            }
+        }, 5);
+
+        std::printf("mat4 product: %d/63 differ bitwise from lab4's loop, %.2f ns vs %.2f ns (checksum %.3f)\n",
+                    mismatches, productTime / 1e5, scalarTime / 1e5, a.m[0]);
+        if (mismatches > 0)
+        {
+            std::printf("FAILED mat4 product: %d products differ bitwise\n", mismatches);
+            ++failures;
+        }
+    }
+
+    void checkNormalize(std::size_t count)
+    {
+        std::vector<vec3> vectors = randomVectors(count, 1000.0f);
+        std::vector<vec3> exact(count), fast(count);
+        std::vector<float> x(count), y(count), z(count);
+
+        double legacyTime = measureNanoseconds([&]
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                exact[i] = legacy::normalize(vectors[i]);
+            }
+        }, 10);
+        double fastTime = measureNanoseconds([&]
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                fast[i] = vectors[i].fastNormalize();
+            }
+        }, 10);
+        double batchTime = measureNanoseconds([&]
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                x[i] = vectors[i].x;
+                y[i] = vectors[i].y;
+                z[i] = vectors[i].z;
+            }
+            normalizeVectors(x.data(), y.data(), z.data(), count);
+        }, 10);
+
+        float exactError = 0.0f, fastError = 0.0f, batchError = 0.0f;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            exactError = std::max(exactError, largestDifference(vectors[i].normalize(), exact[i]));
+            fastError = std::max(fastError, largestDifference(fast[i], exact[i]));
+            batchError = std::max(batchError, largestDifference(vec3(x[i], y[i], z[i]), exact[i]));
+        }
+
+        std::printf("normalize %zu vectors: sqrt + divide %.2f ns, fastNormalize %.2f ns, normalizeVectors %.2f ns (with the SoA copy)\n",
+                    count, legacyTime / count, fastTime / count, batchTime / count);
+        std::printf("    largest difference from sqrt + divide: normalize %.2e, fastNormalize %.2e, normalizeVectors %.2e\n",
+                    exactError, fastError, batchError);
+        expectWithin("normalize", exactError, NORMALIZE_TOLERANCE);
+        expectWithin("fastNormalize", fastError, NORMALIZE_TOLERANCE);
+        expectWithin("normalizeVectors", batchError, NORMALIZE_TOLERANCE);
+    }
+
+    void checkBatchKernels(std::size_t count)
+    {
+        std::vector<vec3> a = randomVectors(count, 1.0f), b = randomVectors(count + 1, 1.0f);
+        std::vector<float> ax(count), ay(count), az(count), bx(count), by(count), bz(count), dots(count), outX(count), outY(count), outZ(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            ax[i] = a[i].x;
+            ay[i] = a[i].y;
+            az[i] = a[i].z;
+            bx[i] = b[i + 1].x;
+            by[i] = b[i + 1].y;
+            bz[i] = b[i + 1].z;
+        }
+
+        mat3 rotation = mat3::rotationZ(0.4f) * mat3::rotationX(1.1f);
+        dotProducts(ax.data(), ay.data(), az.data(), bx.data(), by.data(), bz.data(), count, dots.data());
+        rotateVectors(rotation, ax.data(), ay.data(), az.data(), count, outX.data(), outY.data(), outZ.data());
+
+        float dotError = 0.0f, rotateError = 0.0f;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            dotError = std::max(dotError, std::abs(dots[i] - dot(a[i], b[i + 1])));
+            rotateError = std::max(rotateError, largestDifference(vec3(outX[i], outY[i], outZ[i]), rotation * a[i]));
+        }
+
+        std::printf("batch %zu vectors: dotProducts vs dot %.2e, rotateVectors vs mat3 %.2e\n", count, dotError, rotateError);
+        expectWithin("dotProducts", dotError, DOT_TOLERANCE);
+        expectWithin("rotateVectors", rotateError, ROTATE_TOLERANCE);
+    }
+
+    void checkQuaternions()
+    {
+        std::vector<vec3> axes = randomVectors(100, 1.0f);
+        std::vector<vec3> points = randomVectors(100, 10.0f);
+        float axisError = 0.0f, matrixError = 0.0f;
+        for (std::size_t i = 0; i < axes.size(); ++i)
+        {
+            float angle = 0.063f * i;
+            quat aboutX = quat::fromAxisAngle({1.0f, 0.0f, 0.0f}, angle);
+            quat aboutY = quat::fromAxisAngle({0.0f, 1.0f, 0.0f}, -angle);
+            axisError = std::max(axisError, largestDifference((aboutY * aboutX).rotate(points[i]), mat3::rotationY(-angle) * mat3::rotationX(angle) * points[i]));
+
+            quat q = quat::fromAxisAngle(axes[i].normalize(), angle);
+            matrixError = std::max(matrixError, largestDifference(q.rotate(points[i]), q.toMat3() * points[i]));
+        }
+
+        std::printf("quat: axis rotations vs mat3 %.2e, rotate vs toMat3 %.2e\n", axisError, matrixError);
+        expectWithin("quat axis rotations", axisError, QUATERNION_AXIS_TOLERANCE);
+        expectWithin("quat toMat3", matrixError, QUATERNION_MATRIX_TOLERANCE);
+    }
+}
+
+int main()
+{
+#if defined(__AVX__)
+    std::printf("batch kernels: AVX, 8 values per iteration\n");
+#elif defined(__SSE2__) || defined(_M_X64)
+    std::printf("batch kernels: SSE, 4 values per iteration\n");
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    std::printf("batch kernels: NEON, 4 values per iteration\n");
+#else
+    std::printf("batch kernels: scalar\n");
+#endif
+
+    checkTransforms(10007);
+    checkMatrixProduct();
+    checkNormalize(100003);
+    checkBatchKernels(10007);
+    checkQuaternions();
+
+    if (failures > 0)
+    {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("all checks within tolerance\n");
+    return 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+// Best of repetitions runs of function, in nanoseconds, for the labs' benchmark programs.
+// The best run rather than the mean, so a context switch does not skew a comparison.
+template<typename Function>
+double measureNanoseconds(Function &&function, int repetitions)
+{
+    auto best = std::chrono::nanoseconds::max();
+    for (int i = 0; i < repetitions; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        best = std::min(best, elapsed);
+    }
+    return static_cast<double>(best.count());
+}
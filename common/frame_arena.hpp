@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// The block a FrameArena starts with. It grows to fit the largest frame it has served.
+constexpr std::size_t FRAME_ARENA_INITIAL_BYTES = 1 << 16;
+
+// Bump allocator for buffers that live for one frame. allocate() hands out aligned space
+// from the current block and nothing is freed on its own; reset() at the top of each frame
+// makes all of it free again. A frame that outgrows the block chains extra blocks, and the
+// next reset() replaces them with one block of the combined size, so once the frame loop
+// has warmed up the arena stops touching the heap.
+class FrameArena
+{
+public:
+    explicit FrameArena(std::size_t initialBytes = FRAME_ARENA_INITIAL_BYTES)
+    {
+        addBlock(std::max<std::size_t>(initialBytes, 64));
+    }
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    // alignment must be a power of two.
+    void *allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+    {
+        std::uintptr_t aligned = (_cursor + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+        if (aligned + bytes > _end)
+        {
+            addBlock(std::max(bytes + alignment, _blocks.back().size * 2));
+            aligned = (_cursor + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+        }
+        _used += aligned + bytes - _cursor;
+        _cursor = aligned + bytes;
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    // Uninitialized room for count values of T; nothing destroys them.
+    template<typename T>
+    T *allocate(std::size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is released without running destructors");
+        return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Releases everything allocated since the last reset. Anything still pointing into
+    // the arena is invalid afterwards.
+    void reset()
+    {
+        _peak = std::max(_peak, _used);
+        if (_blocks.size() > 1)
+        {
+            std::size_t total = 0;
+            for (const auto &block: _blocks)
+            {
+                total += block.size;
+            }
+            _blocks.clear();
+            addBlock(total);
+        }
+        _cursor = reinterpret_cast<std::uintptr_t>(_blocks.back().data.get());
+        _end = _cursor + _blocks.back().size;
+        _used = 0;
+    }
+
+    // Bytes handed out since the last reset, alignment padding included.
+    std::size_t bytesUsed() const noexcept
+    {
+        return _used;
+    }
+
+    // The most any frame has used.
+    std::size_t peakBytes() const noexcept
+    {
+        return std::max(_peak, _used);
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        std::size_t total = 0;
+        for (const auto &block: _blocks)
+        {
+            total += block.size;
+        }
+        return total;
+    }
+
+    // Heap allocations the arena itself has made for blocks.
+    std::size_t blockAllocations() const noexcept
+    {
+        return _blockAllocations;
+    }
+
+private:
+    struct Block
+    {
+        std::unique_ptr<unsigned char[]> data;
+        std::size_t size;
+    };
+
+    void addBlock(std::size_t size)
+    {
+        _blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+        ++_blockAllocations;
+        _cursor = reinterpret_cast<std::uintptr_t>(_blocks.back().data.get());
+        _end = _cursor + size;
+    }
+
+    std::vector<Block> _blocks;
+    std::uintptr_t _cursor = 0;
+    std::uintptr_t _end = 0;
+    std::size_t _used = 0;
+    std::size_t _peak = 0;
+    std::size_t _blockAllocations = 0;
+};
+
+// Standard allocator over a FrameArena, for containers that live within one frame.
+// deallocate() is a no-op, so a growing vector leaves its old buffers behind until the
+// reset; reserve() first where the size is known.
+template<typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    // Implicit, so a container can be built straight from the arena.
+    ArenaAllocator(FrameArena &arena) noexcept:
+        _arena(&arena)
+    {
+
+    }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept:
+        _arena(&other.arena())
+    {
+
+    }
+
+    T *allocate(std::size_t count)
+    {
+        return static_cast<T *>(_arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, std::size_t) noexcept
+    {
+
+    }
+
+    FrameArena &arena() const noexcept
+    {
+        return *_arena;
+    }
+
+private:
+    FrameArena *_arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) noexcept
+{
+    return &a.arena() == &b.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) noexcept
+{
+    return !(a == b);
+}
+
+// A vector whose storage comes from a FrameArena: FrameVector<sf::Vertex> quads(arena).
+template<typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
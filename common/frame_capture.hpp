@@ -0,0 +1,285 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Frames held between the render loop and the writer. At 800x600 RGBA a slot is 1.9 MB.
+constexpr std::size_t CAPTURE_SLOTS = 8;
+
+enum class CaptureFormat
+{
+    // One YUV4MPEG2 stream with full-resolution 4:4:4 chroma, playable by ffplay and mpv.
+    Y4M,
+    // Numbered binary PPM files; a frame dropped while the writer is behind leaves a gap.
+    PPM
+};
+
+struct CaptureStats
+{
+    std::uint64_t captured = 0;
+    std::uint64_t written = 0;
+    std::uint64_t dropped = 0;
+    // Frames waiting for the writer, including the one it is writing.
+    std::size_t queueDepth = 0;
+    std::size_t maxQueueDepth = 0;
+};
+
+// Streams RGBA frames to disk from a writer thread, so the render loop only pays for one
+// copy into a preallocated slot. When every slot is still waiting for the writer, the new
+// frame is dropped and counted rather than waiting for the disk.
+class FrameCapture
+{
+public:
+    // For PPM, path is a printf pattern for the frame number, an unsigned long long counted
+    // from 1, e.g. "capture_%05llu.ppm".
+    FrameCapture(const std::string &path, CaptureFormat format, int width, int height, int framesPerSecond = 60,
+                 std::size_t slots = CAPTURE_SLOTS):
+        _path(path), _format(format), _width(width), _height(height), _slots(slots),
+        _frameNumbers(slots, 0), _bottomUp(slots, 0)
+    {
+        std::size_t pixels = static_cast<std::size_t>(width) * height;
+        for (auto &slot: _slots)
+        {
+            slot.resize(pixels * 4);
+        }
+        _converted.resize(pixels * 3);
+
+        if (_format == CaptureFormat::Y4M)
+        {
+            _file = std::fopen(path.c_str(), "wb");
+            if (!_file || std::fprintf(_file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, framesPerSecond) < 0)
+            {
+                _error = "cannot write " + path;
+                return;
+            }
+        }
+        _writer = std::thread(&FrameCapture::writeLoop, this);
+    }
+
+    ~FrameCapture()
+    {
+        finish();
+    }
+
+    FrameCapture(const FrameCapture &) = delete;
+    FrameCapture &operator=(const FrameCapture &) = delete;
+
+    bool ok() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _error.empty();
+    }
+
+    std::string error() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _error;
+    }
+
+    int width() const noexcept
+    {
+        return _width;
+    }
+
+    int height() const noexcept
+    {
+        return _height;
+    }
+
+    // A free slot for width * height RGBA pixels, to be filled and handed back with
+    // submit(), or nullptr when the frame has to be dropped. One producer thread only.
+    std::uint8_t *acquire()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_frameNumber;
+        if (_queued == _slots.size() || _stopping || !_error.empty())
+        {
+            ++_stats.dropped;
+            return nullptr;
+        }
+        std::size_t slot = (_first + _queued) % _slots.size();
+        _frameNumbers[slot] = _frameNumber;
+        return _slots[slot].data();
+    }
+
+    // Queues the slot from the last acquire(). bottomUp marks pixels read back from
+    // OpenGL, whose first row is the bottom of the image.
+    void submit(bool bottomUp)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _bottomUp[(_first + _queued) % _slots.size()] = bottomUp;
+            ++_queued;
+            ++_stats.captured;
+            _stats.maxQueueDepth = std::max(_stats.maxQueueDepth, _queued);
+        }
+        _ready.notify_one();
+    }
+
+    // Copies one frame of width * height RGBA pixels, top row first. Returns false if it
+    // was dropped.
+    bool push(const std::uint8_t *pixels)
+    {
+        std::uint8_t *slot = acquire();
+        if (!slot)
+        {
+            return false;
+        }
+        std::memcpy(slot, pixels, static_cast<std::size_t>(_width) * _height * 4);
+        submit(false);
+        return true;
+    }
+
+    // Writes every frame still queued, stops the writer and closes the video. Frames
+    // acquired afterwards are dropped.
+    void finish()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _ready.notify_one();
+        if (_writer.joinable())
+        {
+            _writer.join();
+        }
+        if (_file)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (std::fclose(_file) != 0 && _error.empty())
+            {
+                _error = "cannot write " + _path;
+            }
+            _file = nullptr;
+        }
+    }
+
+    CaptureStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        CaptureStats stats = _stats;
+        stats.queueDepth = _queued;
+        return stats;
+    }
+
+private:
+    void writeLoop()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true)
+        {
+            _ready.wait(lock, [this]
+            {
+                return _queued > 0 || _stopping;
+            });
+            if (_queued == 0)
+            {
+                return;
+            }
+
+            // The slot at _first stays out of the producer's reach until _queued drops.
+            std::size_t slot = _first;
+            lock.unlock();
+            bool written = _format == CaptureFormat::Y4M ? writeY4M(slot) : writePPM(slot);
+            lock.lock();
+
+            _first = (_first + 1) % _slots.size();
+            --_queued;
+            if (written)
+            {
+                ++_stats.written;
+            }
+            else if (_error.empty())
+            {
+                _error = "cannot write " + (_format == CaptureFormat::Y4M ? _path : framePath(_frameNumbers[slot]));
+            }
+        }
+    }
+
+    // Row y of the image, top first, from a slot in either row order.
+    const std::uint8_t *row(std::size_t slot, int y) const
+    {
+        int stored = _bottomUp[slot] ? _height - 1 - y : y;
+        return _slots[slot].data() + static_cast<std::size_t>(stored) * _width * 4;
+    }
+
+    // BT.601 limited range, the default players assume for Y4M.
+    bool writeY4M(std::size_t slot)
+    {
+        std::size_t plane = static_cast<std::size_t>(_width) * _height;
+        std::uint8_t *luma = _converted.data(), *blue = luma + plane, *red = blue + plane;
+        for (int y = 0; y < _height; ++y)
+        {
+            const std::uint8_t *pixel = row(slot, y);
+            std::size_t out = static_cast<std::size_t>(y) * _width;
+            for (int x = 0; x < _width; ++x, pixel += 4, ++out)
+            {
+                int r = pixel[0], g = pixel[1], b = pixel[2];
+                luma[out] = static_cast<std::uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+                blue[out] = static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+                red[out] = static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+            }
+        }
+        return std::fputs("FRAME\n", _file) >= 0 && std::fwrite(_converted.data(), 1, _converted.size(), _file) == _converted.size();
+    }
+
+    bool writePPM(std::size_t slot)
+    {
+        std::uint8_t *out = _converted.data();
+        for (int y = 0; y < _height; ++y)
+        {
+            const std::uint8_t *pixel = row(slot, y);
+            for (int x = 0; x < _width; ++x, pixel += 4, out += 3)
+            {
+                out[0] = pixel[0];
+                out[1] = pixel[1];
+                out[2] = pixel[2];
+            }
+        }
+
+        std::FILE *file = std::fopen(framePath(_frameNumbers[slot]).c_str(), "wb");
+        if (!file)
+        {
+            return false;
+        }
+        bool written = std::fprintf(file, "P6\n%d %d\n255\n", _width, _height) > 0 &&
+                       std::fwrite(_converted.data(), 1, _converted.size(), file) == _converted.size();
+        return std::fclose(file) == 0 && written;
+    }
+
+    std::string framePath(std::uint64_t frame) const
+    {
+        char path[1024];
+        std::snprintf(path, sizeof(path), _path.c_str(), static_cast<unsigned long long>(frame));
+        return path;
+    }
+
+    std::string _path;
+    CaptureFormat _format;
+    int _width, _height;
+    std::vector<std::vector<std::uint8_t>> _slots;
+    std::vector<std::uint64_t> _frameNumbers;
+    // Bytes rather than vector<bool>, whose packed bits the two threads would share.
+    std::vector<std::uint8_t> _bottomUp;
+    // The writer's RGB or YUV staging frame.
+    std::vector<std::uint8_t> _converted;
+    std::FILE *_file = nullptr;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _ready;
+    std::size_t _first = 0;
+    std::size_t _queued = 0;
+    std::uint64_t _frameNumber = 0;
+    bool _stopping = false;
+    CaptureStats _stats;
+    std::string _error;
+    std::thread _writer;
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "frame_capture.hpp"
+#include "profiler.hpp"
+
+// Records the window through a FrameCapture. F3 starts and stops a <basePath>.y4m video;
+// Shift+F3 writes numbered <basePath>_00001.ppm files instead. Recording stops by itself
+// if the window is resized. Stopping waits for the queued frames and prints how many were
+// written and dropped.
+class FrameRecorder
+{
+public:
+    // framesPerSecond only goes into the Y4M header, for playback speed.
+    explicit FrameRecorder(const std::string &basePath, int framesPerSecond = 60):
+        _basePath(basePath), _framesPerSecond(framesPerSecond)
+    {
+
+    }
+
+    ~FrameRecorder()
+    {
+        stop();
+    }
+
+    bool recording() const noexcept
+    {
+        return _capture || _starting;
+    }
+
+    // Returns true when the event was the recorder's key.
+    bool handleEvent(const sf::Event &event)
+    {
+        if (event.type != sf::Event::KeyPressed || event.key.code != sf::Keyboard::F3)
+        {
+            return false;
+        }
+        if (recording())
+        {
+            stop();
+        }
+        else
+        {
+            // The window size is only known in capture(), which opens the output.
+            _starting = true;
+            _format = event.key.shift ? CaptureFormat::PPM : CaptureFormat::Y4M;
+        }
+        return true;
+    }
+
+    // Reads the finished frame back into the capture ring. Call after drawing and before
+    // display(); draw overlays after it to keep them out of the recording.
+    void capture(sf::RenderWindow &window)
+    {
+        sf::Vector2u size = window.getSize();
+        if (_starting)
+        {
+            _starting = false;
+            start(size);
+        }
+        if (!_capture)
+        {
+            return;
+        }
+        if (!window.isOpen() || !_capture->ok())
+        {
+            stop();
+            return;
+        }
+        if (size.x != static_cast<unsigned>(_capture->width()) || size.y != static_cast<unsigned>(_capture->height()))
+        {
+            std::cerr << "Window resized, stopping the recording" << std::endl;
+            stop();
+            return;
+        }
+
+        PROFILE_ZONE("capture");
+        std::uint8_t *pixels = _capture->acquire();
+        if (!pixels)
+        {
+            if (!_warned)
+            {
+                std::cerr << "Frame capture is behind the disk, dropping frames" << std::endl;
+                _warned = true;
+            }
+            return;
+        }
+        window.setActive(true);
+        glReadPixels(0, 0, _capture->width(), _capture->height(), GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        _capture->submit(true);
+    }
+
+    // Current counts, for a title bar or overlay; all zero while not recording.
+    CaptureStats stats() const
+    {
+        return _capture ? _capture->stats() : CaptureStats();
+    }
+
+    void stop()
+    {
+        _starting = false;
+        if (!_capture)
+        {
+            return;
+        }
+
+        _capture->finish();
+        CaptureStats stats = _capture->stats();
+        if (!_capture->ok())
+        {
+            std::cerr << "Frame capture failed: " << _capture->error() << std::endl;
+        }
+        std::cerr << "Recorded " << stats.captured << " frames to " << _path << ": " << stats.written << " written, "
+                  << stats.dropped << " dropped, queue depth up to " << stats.maxQueueDepth << std::endl;
+        _capture.reset();
+    }
+
+private:
+    void start(const sf::Vector2u &size)
+    {
+        _path = _basePath + (_format == CaptureFormat::Y4M ? ".y4m" : "_%05llu.ppm");
+        _capture.reset(new FrameCapture(_path, _format, static_cast<int>(size.x), static_cast<int>(size.y), _framesPerSecond));
+        if (!_capture->ok())
+        {
+            std::cerr << "Failed to start frame capture: " << _capture->error() << std::endl;
+            _capture.reset();
+            return;
+        }
+        _warned = false;
+        std::cerr << "Recording to " << _path << std::endl;
+    }
+
+    std::string _basePath;
+    std::string _path;
+    int _framesPerSecond;
+    CaptureFormat _format = CaptureFormat::Y4M;
+    std::unique_ptr<FrameCapture> _capture;
+    bool _starting = false;
+    bool _warned = false;
+};
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Metrics a lab updates from its frame loop and MetricsServer exposes in the Prometheus
+// text format. Updates are single relaxed atomic operations with no locks, so they can sit
+// in hot loops; a scrape reads the values while they change and may see one update in one
+// series and not yet in another.
+
+class Counter
+{
+public:
+    void add(std::uint64_t amount = 1) noexcept
+    {
+        _value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    std::uint64_t value() const noexcept
+    {
+        return _value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::uint64_t> _value{0};
+};
+
+class Gauge
+{
+public:
+    void set(double value) noexcept
+    {
+        _value.store(value, std::memory_order_relaxed);
+    }
+
+    double value() const noexcept
+    {
+        return _value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<double> _value{0.0};
+};
+
+// Counts observations per bucket. bounds are the ascending upper bounds of the buckets;
+// values above the last bound fall into the +Inf bucket.
+class Histogram
+{
+public:
+    explicit Histogram(std::vector<double> bounds):
+        _bounds(std::move(bounds)), _buckets(new std::atomic<std::uint64_t>[_bounds.size() + 1])
+    {
+        for (std::size_t i = 0; i <= _bounds.size(); ++i)
+        {
+            _buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void observe(double value) noexcept
+    {
+        std::size_t bucket = std::lower_bound(_bounds.begin(), _bounds.end(), value) - _bounds.begin();
+        _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+        double sum = _sum.load(std::memory_order_relaxed);
+        while (!_sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed))
+        {
+
+        }
+    }
+
+    const std::vector<double> &bounds() const noexcept
+    {
+        return _bounds;
+    }
+
+    // Observations in bucket i alone; i == bounds().size() is the +Inf bucket.
+    std::uint64_t bucket(std::size_t i) const noexcept
+    {
+        return _buckets[i].load(std::memory_order_relaxed);
+    }
+
+    double sum() const noexcept
+    {
+        return _sum.load(std::memory_order_relaxed);
+    }
+
+    // count bounds growing by factor, from first: exponentialBounds(0.001, 2, 4) is
+    // 1, 2, 4 and 8 ms in seconds.
+    static std::vector<double> exponentialBounds(double first, double factor, std::size_t count)
+    {
+        std::vector<double> bounds;
+        for (double bound = first; bounds.size() < count; bound *= factor)
+        {
+            bounds.push_back(bound);
+        }
+        return bounds;
+    }
+
+private:
+    std::vector<double> _bounds;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> _buckets;
+    std::atomic<double> _sum{0.0};
+};
+
+// Owns the metrics and writes them in the Prometheus text exposition format. Register
+// everything before the frame loop starts; references stay valid for the registry's life.
+// labels is the inside of a label set, such as reason="frustum", and tells apart series
+// of one metric name, which share the help text of the first registration.
+class MetricRegistry
+{
+public:
+    Counter &counter(const std::string &name, const std::string &help, const std::string &labels = "")
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Series &series = add(name, help, "counter", labels);
+        series.counter.reset(new Counter());
+        return *series.counter;
+    }
+
+    Gauge &gauge(const std::string &name, const std::string &help, const std::string &labels = "")
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Series &series = add(name, help, "gauge", labels);
+        series.gauge.reset(new Gauge());
+        return *series.gauge;
+    }
+
+    Histogram &histogram(const std::string &name, const std::string &help, std::vector<double> bounds, const std::string &labels = "")
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Series &series = add(name, help, "histogram", labels);
+        series.histogram.reset(new Histogram(std::move(bounds)));
+        return *series.histogram;
+    }
+
+    void write(std::ostream &out) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto &family: _families)
+        {
+            out << "# HELP " << family.name << " " << family.help << "\n";
+            out << "# TYPE " << family.name << " " << family.type << "\n";
+            for (const auto &series: family.series)
+            {
+                if (series.counter)
+                {
+                    out << family.name << labelSet(series.labels) << " " << series.counter->value() << "\n";
+                }
+                else if (series.gauge)
+                {
+                    out << family.name << labelSet(series.labels) << " " << number(series.gauge->value()) << "\n";
+                }
+                else
+                {
+                    writeHistogram(out, family.name, series.labels, *series.histogram);
+                }
+            }
+        }
+    }
+
+    std::string text() const
+    {
+        std::ostringstream out;
+        write(out);
+        return out.str();
+    }
+
+private:
+    struct Series
+    {
+        std::string labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    struct Family
+    {
+        std::string name;
+        std::string help;
+        std::string type;
+        std::vector<Series> series;
+    };
+
+    Series &add(const std::string &name, const std::string &help, const char *type, const std::string &labels)
+    {
+        auto family = std::find_if(_families.begin(), _families.end(), [&](const Family &f)
+        {
+            return f.name == name;
+        });
+        if (family == _families.end())
+        {
+            _families.push_back({name, help, type, {}});
+            family = _families.end() - 1;
+        }
+        family->series.emplace_back();
+        family->series.back().labels = labels;
+        return family->series.back();
+    }
+
+    static std::string labelSet(const std::string &labels, const std::string &extra = "")
+    {
+        if (labels.empty() && extra.empty())
+        {
+            return "";
+        }
+        return "{" + labels + (labels.empty() || extra.empty() ? "" : ",") + extra + "}";
+    }
+
+    static std::string number(double value)
+    {
+        if (value != value)
+        {
+            return "NaN";
+        }
+        if (value > 1e308 || value < -1e308)
+        {
+            return value > 0 ? "+Inf" : "-Inf";
+        }
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.9g", value);
+        return text;
+    }
+
+    // Prometheus buckets are cumulative, and _count must equal the +Inf bucket, so both
+    // come from one pass over the per-bucket counts.
+    static void writeHistogram(std::ostream &out, const std::string &name, const std::string &labels, const Histogram &histogram)
+    {
+        std::uint64_t cumulative = 0;
+        for (std::size_t i = 0; i < histogram.bounds().size(); ++i)
+        {
+            cumulative += histogram.bucket(i);
+            out << name << "_bucket" << labelSet(labels, "le=\"" + number(histogram.bounds()[i]) + "\"") << " " << cumulative << "\n";
+        }
+        cumulative += histogram.bucket(histogram.bounds().size());
+        out << name << "_bucket" << labelSet(labels, "le=\"+Inf\"") << " " << cumulative << "\n";
+        out << name << "_sum" << labelSet(labels) << " " << number(histogram.sum()) << "\n";
+        out << name << "_count" << labelSet(labels) << " " << cumulative << "\n";
+    }
+
+    mutable std::mutex _mutex;
+    std::vector<Family> _families;
+};
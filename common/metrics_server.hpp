@@ -0,0 +1,284 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define METRICS_SERVER_SUPPORTED 1
+#if defined(MSG_NOSIGNAL)
+#define METRICS_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define METRICS_SEND_FLAGS 0
+#endif
+#else
+#define METRICS_SERVER_SUPPORTED 0
+#endif
+
+#include "metrics.hpp"
+
+// Milliseconds the server thread waits between checks for shutdown, and at most for a
+// scraper to send its request.
+constexpr int METRICS_POLL_MS = 100;
+constexpr int METRICS_REQUEST_TIMEOUT_MS = 1000;
+
+// Serves a registry over HTTP/1.0 on its own thread, one connection at a time: GET /metrics
+// (or /) answers with the registry's text. address is a TCP port, bound to 127.0.0.1 only
+// (0 picks a free one, see port()), or a Unix socket path containing a '/'; a stale socket
+// left at that path is replaced. Scrape with
+//     curl http://127.0.0.1:9100/metrics
+//     curl --unix-socket /tmp/lab5.sock http://localhost/metrics
+// or point a Prometheus job at the port.
+class MetricsServer
+{
+public:
+    MetricsServer(const MetricRegistry &registry, const std::string &address):
+        _registry(registry), _address(address)
+    {
+#if METRICS_SERVER_SUPPORTED
+        if (listen())
+        {
+            _thread = std::thread(&MetricsServer::serve, this);
+        }
+#else
+        _error = "metrics server needs POSIX sockets";
+#endif
+    }
+
+    ~MetricsServer()
+    {
+        _stopping.store(true, std::memory_order_relaxed);
+        if (_thread.joinable())
+        {
+            _thread.join();
+        }
+#if METRICS_SERVER_SUPPORTED
+        if (_socket >= 0)
+        {
+            ::close(_socket);
+            if (isUnixPath(_address))
+            {
+                ::unlink(_address.c_str());
+            }
+        }
+#endif
+    }
+
+    MetricsServer(const MetricsServer &) = delete;
+    MetricsServer &operator=(const MetricsServer &) = delete;
+
+    bool listening() const noexcept
+    {
+        return _socket >= 0;
+    }
+
+    // Why the server is not listening.
+    const std::string &error() const noexcept
+    {
+        return _error;
+    }
+
+    // The bound TCP port, or 0 for a Unix socket.
+    int port() const noexcept
+    {
+        return _port;
+    }
+
+    // The scrape URL, or the socket path.
+    std::string endpoint() const
+    {
+        return isUnixPath(_address) ? _address : "http://127.0.0.1:" + std::to_string(_port) + "/metrics";
+    }
+
+private:
+    static bool isUnixPath(const std::string &address)
+    {
+        return address.find('/') != std::string::npos;
+    }
+
+#if METRICS_SERVER_SUPPORTED
+    bool fail(const std::string &what)
+    {
+        _error = what + ": " + std::strerror(errno);
+        if (_socket >= 0)
+        {
+            ::close(_socket);
+            _socket = -1;
+        }
+        return false;
+    }
+
+    bool listen()
+    {
+        if (isUnixPath(_address))
+        {
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            if (_address.size() >= sizeof(address.sun_path))
+            {
+                _error = "socket path too long: " + _address;
+                return false;
+            }
+            std::strcpy(address.sun_path, _address.c_str());
+
+            _socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (_socket < 0)
+            {
+                return fail("socket");
+            }
+            struct stat existing;
+            if (::stat(_address.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode))
+            {
+                ::unlink(_address.c_str());
+            }
+            if (::bind(_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0)
+            {
+                return fail("bind " + _address);
+            }
+        }
+        else
+        {
+            char *end = nullptr;
+            long port = std::strtol(_address.c_str(), &end, 10);
+            if (_address.empty() || *end != '\0' || port < 0 || port > 65535)
+            {
+                _error = "expected a port or a socket path, got \"" + _address + "\"";
+                return false;
+            }
+
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<std::uint16_t>(port));
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+            _socket = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (_socket < 0)
+            {
+                return fail("socket");
+            }
+            int reuse = 1;
+            ::setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            if (::bind(_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0)
+            {
+                return fail("bind 127.0.0.1:" + _address);
+            }
+
+            socklen_t length = sizeof(address);
+            ::getsockname(_socket, reinterpret_cast<sockaddr *>(&address), &length);
+            _port = ntohs(address.sin_port);
+        }
+
+        if (::listen(_socket, 4) < 0)
+        {
+            return fail("listen");
+        }
+        return true;
+    }
+
+    void serve()
+    {
+        while (!_stopping.load(std::memory_order_relaxed))
+        {
+            pollfd ready = {_socket, POLLIN, 0};
+            if (::poll(&ready, 1, METRICS_POLL_MS) <= 0)
+            {
+                continue;
+            }
+
+            int client = ::accept(_socket, nullptr, nullptr);
+            if (client >= 0)
+            {
+                respond(client);
+                ::close(client);
+            }
+        }
+    }
+
+    // Reads the request head and answers; anything but a GET of /metrics or / is a 404.
+    void respond(int client)
+    {
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos && request.size() < 8192)
+        {
+            pollfd ready = {client, POLLIN, 0};
+            if (::poll(&ready, 1, METRICS_REQUEST_TIMEOUT_MS) <= 0)
+            {
+                return;
+            }
+            ssize_t received = ::recv(client, buffer, sizeof(buffer), 0);
+            if (received <= 0)
+            {
+                return;
+            }
+            request.append(buffer, static_cast<std::size_t>(received));
+        }
+
+        std::string line = request.substr(0, request.find_first_of("\r\n"));
+        std::string status = "200 OK", body;
+        if (line.compare(0, 13, "GET /metrics ") == 0 || line.compare(0, 6, "GET / ") == 0)
+        {
+            body = _registry.text();
+        }
+        else
+        {
+            status = "404 Not Found";
+            body = "not found; try GET /metrics\n";
+        }
+
+        std::string response = "HTTP/1.0 " + status + "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: " +
+                               std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        for (std::size_t sent = 0; sent < response.size();)
+        {
+            ssize_t written = ::send(client, response.data() + sent, response.size() - sent, METRICS_SEND_FLAGS);
+            if (written <= 0)
+            {
+                return;
+            }
+            sent += static_cast<std::size_t>(written);
+        }
+    }
+#endif
+
+    const MetricRegistry &_registry;
+    std::string _address;
+    std::string _error;
+    int _socket = -1;
+    int _port = 0;
+    std::atomic<bool> _stopping{false};
+    std::thread _thread;
+};
+
+// Starts a server on the address in the METRICS_ADDRESS environment variable, if it is
+// set, and reports where it listens, or why it could not, on std::cerr.
+inline std::unique_ptr<MetricsServer> startMetricsServer(const MetricRegistry &registry)
+{
+    const char *address = std::getenv("METRICS_ADDRESS");
+    if (!address || !*address)
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<MetricsServer> server(new MetricsServer(registry, address));
+    if (server->listening())
+    {
+        std::cerr << "metrics: serving " << server->endpoint() << std::endl;
+    }
+    else
+    {
+        std::cerr << "metrics: " << server->error() << std::endl;
+    }
+    return server;
+}
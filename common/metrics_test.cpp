@@ -0,0 +1,192 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "metrics.hpp"
+#include "metrics_server.hpp"
+
+// Scrapes a MetricsServer over TCP and over a Unix socket the way Prometheus or curl
+// would, and checks the exposition text and the HTTP status. Exits with 1, naming the
+// failed checks, if any fail.
+namespace
+{
+    int failures = 0;
+
+    void expect(const std::string &check, bool passed)
+    {
+        if (!passed)
+        {
+            std::printf("FAILED %s\n", check.c_str());
+            ++failures;
+        }
+    }
+
+#if METRICS_SERVER_SUPPORTED
+    // Sends request to a server at a TCP port or a Unix socket path and returns the whole
+    // response, or an empty string if the connection failed.
+    std::string exchange(const std::string &address, int port, const std::string &request)
+    {
+        int client = -1;
+        if (port == 0)
+        {
+            sockaddr_un unixAddress = {};
+            unixAddress.sun_family = AF_UNIX;
+            std::strncpy(unixAddress.sun_path, address.c_str(), sizeof(unixAddress.sun_path) - 1);
+            client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (client < 0 || ::connect(client, reinterpret_cast<const sockaddr *>(&unixAddress), sizeof(unixAddress)) < 0)
+            {
+                ::close(client);
+                return "";
+            }
+        }
+        else
+        {
+            sockaddr_in tcpAddress = {};
+            tcpAddress.sin_family = AF_INET;
+            tcpAddress.sin_port = htons(static_cast<std::uint16_t>(port));
+            tcpAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            client = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (client < 0 || ::connect(client, reinterpret_cast<const sockaddr *>(&tcpAddress), sizeof(tcpAddress)) < 0)
+            {
+                ::close(client);
+                return "";
+            }
+        }
+
+        ::send(client, request.data(), request.size(), METRICS_SEND_FLAGS);
+        std::string response;
+        char buffer[4096];
+        ssize_t received;
+        while ((received = ::recv(client, buffer, sizeof(buffer), 0)) > 0)
+        {
+            response.append(buffer, static_cast<std::size_t>(received));
+        }
+        ::close(client);
+        return response;
+    }
+
+    std::string body(const std::string &response)
+    {
+        std::size_t end = response.find("\r\n\r\n");
+        return end == std::string::npos ? "" : response.substr(end + 4);
+    }
+
+    bool hasLine(const std::string &text, const std::string &line)
+    {
+        return ("\n" + text).find("\n" + line + "\n") != std::string::npos;
+    }
+
+    // Every _bucket line of the histogram must count at least as many observations as the
+    // one before, and the +Inf bucket must equal _count.
+    void checkCumulative(const std::string &where, const std::string &text, const std::string &name)
+    {
+        std::istringstream lines(text);
+        std::string line, infinity, count;
+        unsigned long long previous = 0;
+        bool cumulative = true;
+        while (std::getline(lines, line))
+        {
+            std::size_t space = line.rfind(' ');
+            if (line.compare(0, name.size() + 8, name + "_bucket{") == 0)
+            {
+                unsigned long long value = std::stoull(line.substr(space + 1));
+                cumulative &= value >= previous;
+                previous = value;
+                if (line.find("le=\"+Inf\"") != std::string::npos)
+                {
+                    infinity = line.substr(space + 1);
+                }
+            }
+            else if (line.compare(0, name.size() + 7, name + "_count ") == 0)
+            {
+                count = line.substr(space + 1);
+            }
+        }
+        expect(where + ": " + name + " buckets are cumulative", cumulative);
+        expect(where + ": " + name + " has a +Inf bucket and a _count", !infinity.empty() && !count.empty());
+        expect(where + ": " + name + "_count equals the +Inf bucket", infinity == count);
+    }
+
+    void checkScrape(const std::string &where, const std::string &address, int port)
+    {
+        std::string response = exchange(address, port, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+        expect(where + ": GET /metrics answers 200", response.compare(0, 15, "HTTP/1.0 200 OK") == 0);
+        expect(where + ": text exposition content type", response.find("Content-Type: text/plain; version=0.0.4") != std::string::npos);
+
+        std::string text = body(response);
+        expect(where + ": counter HELP", hasLine(text, "# HELP test_requests_total Requests handled."));
+        expect(where + ": counter TYPE", hasLine(text, "# TYPE test_requests_total counter"));
+        expect(where + ": counter value", hasLine(text, "test_requests_total 3"));
+        expect(where + ": one TYPE for a labelled family", text.find("# TYPE test_faces_culled_total counter") == text.rfind("# TYPE test_faces_culled_total counter"));
+        expect(where + ": labelled counters", hasLine(text, "test_faces_culled_total{reason=\"frustum\"} 5") &&
+                                              hasLine(text, "test_faces_culled_total{reason=\"backface\"} 7"));
+        expect(where + ": gauge TYPE", hasLine(text, "# TYPE test_temperature gauge"));
+        expect(where + ": gauge value", hasLine(text, "test_temperature 21.5"));
+        expect(where + ": histogram HELP", hasLine(text, "# HELP test_frame_seconds Time between frames."));
+        expect(where + ": histogram TYPE", hasLine(text, "# TYPE test_frame_seconds histogram"));
+        expect(where + ": histogram buckets", hasLine(text, "test_frame_seconds_bucket{le=\"0.001\"} 1") &&
+                                              hasLine(text, "test_frame_seconds_bucket{le=\"0.002\"} 3") &&
+                                              hasLine(text, "test_frame_seconds_bucket{le=\"0.004\"} 4") &&
+                                              hasLine(text, "test_frame_seconds_bucket{le=\"0.008\"} 4") &&
+                                              hasLine(text, "test_frame_seconds_bucket{le=\"+Inf\"} 5"));
+        expect(where + ": histogram _sum", hasLine(text, "test_frame_seconds_sum 0.1065"));
+        expect(where + ": histogram _count", hasLine(text, "test_frame_seconds_count 5"));
+        checkCumulative(where, text, "test_frame_seconds");
+
+        expect(where + ": GET / answers 200", exchange(address, port, "GET / HTTP/1.0\r\n\r\n").compare(0, 15, "HTTP/1.0 200 OK") == 0);
+        expect(where + ": other paths answer 404",
+               exchange(address, port, "GET /other HTTP/1.0\r\n\r\n").compare(0, 22, "HTTP/1.0 404 Not Found") == 0);
+        expect(where + ": other methods answer 404",
+               exchange(address, port, "POST /metrics HTTP/1.0\r\n\r\n").compare(0, 22, "HTTP/1.0 404 Not Found") == 0);
+    }
+#endif
+}
+
+int main()
+{
+#if METRICS_SERVER_SUPPORTED
+    MetricRegistry registry;
+    registry.counter("test_requests_total", "Requests handled.").add(3);
+    registry.counter("test_faces_culled_total", "Faces dropped.", "reason=\"frustum\"").add(5);
+    registry.counter("test_faces_culled_total", "Faces dropped.", "reason=\"backface\"").add(7);
+    registry.gauge("test_temperature", "A gauge.").set(21.5);
+    Histogram &frames = registry.histogram("test_frame_seconds", "Time between frames.", Histogram::exponentialBounds(0.001, 2, 4));
+    for (double seconds: {0.0005, 0.0015, 0.0015, 0.003, 0.1})
+    {
+        frames.observe(seconds);
+    }
+
+    {
+        MetricsServer server(registry, "0");
+        expect("TCP server listens on a free port (" + server.error() + ")", server.listening() && server.port() > 0);
+        if (server.listening())
+        {
+            checkScrape("TCP", "", server.port());
+        }
+    }
+
+    std::string path = "/tmp/metrics_test_" + std::to_string(::getpid()) + ".sock";
+    {
+        MetricsServer server(registry, path);
+        expect("Unix socket server listens (" + server.error() + ")", server.listening());
+        if (server.listening())
+        {
+            checkScrape("Unix socket", path, 0);
+        }
+    }
+    struct stat removed;
+    expect("Unix socket removed on shutdown", ::stat(path.c_str(), &removed) != 0);
+
+    if (failures > 0)
+    {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("all metrics checks passed\n");
+#else
+    std::printf("metrics server needs POSIX sockets, nothing to check\n");
+#endif
+    return 0;
+}
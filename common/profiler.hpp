@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Build with -DPROFILER_ENABLED=0 to compile every PROFILE_ZONE out. When compiled in,
+// zones cost one relaxed load until the profiler is switched on at run time.
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+// Zones kept per thread; older ones are overwritten. A power of two.
+constexpr std::size_t PROFILER_RING_CAPACITY = 1 << 14;
+
+// One finished zone. name points at the string literal given to PROFILE_ZONE; times are
+// nanoseconds since the profiler was created.
+struct ZoneRecord
+{
+    const char *name;
+    std::uint64_t start;
+    std::uint64_t end;
+    std::uint32_t thread;
+    std::uint32_t depth;
+};
+
+// The zones of one thread. Only the owning thread writes, without locks; readers copy
+// the slots behind _head and then drop any the writer claimed again while they copied.
+class ZoneRing
+{
+public:
+    ZoneRing(std::uint32_t thread, const std::string &name):
+        _thread(thread), _name(name)
+    {
+
+    }
+
+    std::uint32_t thread() const noexcept
+    {
+        return _thread;
+    }
+
+    const std::string &name() const noexcept
+    {
+        return _name;
+    }
+
+    void setName(const std::string &name)
+    {
+        _name = name;
+    }
+
+    std::uint32_t enter() noexcept
+    {
+        return _depth++;
+    }
+
+    void leave(const char *name, std::uint64_t start, std::uint64_t end, std::uint32_t depth) noexcept
+    {
+        --_depth;
+        std::uint64_t index = _head.load(std::memory_order_relaxed);
+        _claimed.store(index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        Slot &slot = _slots[index & (PROFILER_RING_CAPACITY - 1)];
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.start.store(start, std::memory_order_relaxed);
+        slot.end.store(end, std::memory_order_relaxed);
+        slot.depth.store(depth, std::memory_order_relaxed);
+
+        _head.store(index + 1, std::memory_order_release);
+    }
+
+    // Appends the zones numbered from `from` on that the ring still holds and returns the
+    // number to continue from.
+    std::uint64_t copy(std::uint64_t from, std::vector<ZoneRecord> &out) const
+    {
+        std::uint64_t head = _head.load(std::memory_order_acquire);
+        std::uint64_t first = std::max(from, head > PROFILER_RING_CAPACITY ? head - PROFILER_RING_CAPACITY : 0);
+        std::size_t begin = out.size();
+        for (std::uint64_t i = first; i < head; ++i)
+        {
+            const Slot &slot = _slots[i & (PROFILER_RING_CAPACITY - 1)];
+            out.push_back({slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+                           slot.end.load(std::memory_order_relaxed), _thread, slot.depth.load(std::memory_order_relaxed)});
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        std::uint64_t claimed = _claimed.load(std::memory_order_relaxed);
+        if (claimed > PROFILER_RING_CAPACITY && claimed - PROFILER_RING_CAPACITY > first)
+        {
+            std::size_t overwritten = std::min(claimed - PROFILER_RING_CAPACITY - first, head - first);
+            out.erase(out.begin() + begin, out.begin() + begin + overwritten);
+        }
+        return head;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<const char *> name{nullptr};
+        std::atomic<std::uint64_t> start{0};
+        std::atomic<std::uint64_t> end{0};
+        std::atomic<std::uint32_t> depth{0};
+    };
+
+    std::uint32_t _thread;
+    std::string _name;
+    std::uint32_t _depth = 0;
+    std::atomic<std::uint64_t> _head{0};
+    std::atomic<std::uint64_t> _claimed{0};
+    Slot _slots[PROFILER_RING_CAPACITY];
+};
+
+// Owns one ZoneRing per thread that has recorded a zone. The mutex guards only the list
+// of rings, which changes when a thread records its first zone.
+class Profiler
+{
+public:
+    static Profiler &instance()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    bool enabled() const noexcept
+    {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    void setEnabled(bool enabled) noexcept
+    {
+        _enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    std::uint64_t now() const noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _epoch).count();
+    }
+
+    ZoneRing &threadRing()
+    {
+        ZoneRing *&ring = localRing();
+        if (!ring)
+        {
+            ring = registerThread();
+        }
+        return *ring;
+    }
+
+    // Names the calling thread in exported traces. A thread that has not recorded a zone
+    // yet gets its ring, and the name, with its first zone.
+    void nameThread(const std::string &name)
+    {
+        localName() = name;
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (ZoneRing *ring = localRing())
+        {
+            ring->setName(name);
+        }
+    }
+
+    // Every zone the rings still hold.
+    void snapshot(std::vector<ZoneRecord> &out) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto &ring: _rings)
+        {
+            ring->copy(0, out);
+        }
+    }
+
+    // The zones finished since the previous drain. Meant for a single consumer, such as
+    // the overlay on the main thread.
+    void drain(std::vector<ZoneRecord> &out)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _drained.resize(_rings.size(), 0);
+        for (std::size_t i = 0; i < _rings.size(); ++i)
+        {
+            _drained[i] = _rings[i]->copy(_drained[i], out);
+        }
+    }
+
+    // Chrome trace-event JSON, for chrome://tracing or ui.perfetto.dev.
+    void writeChromeTrace(std::ostream &out) const
+    {
+        std::vector<ZoneRecord> records;
+        snapshot(records);
+        std::sort(records.begin(), records.end(), [](const ZoneRecord &a, const ZoneRecord &b)
+        {
+            return a.start < b.start;
+        });
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (const auto &ring: _rings)
+            {
+                out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->thread()
+                    << ",\"args\":{\"name\":\"" << escaped(ring->name()) << "\"}}";
+                first = false;
+            }
+        }
+        for (const auto &record: records)
+        {
+            out << (first ? "" : ",\n") << "{\"name\":\"" << escaped(record.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << record.thread
+                << ",\"ts\":" << microseconds(record.start) << ",\"dur\":" << microseconds(record.end - record.start) << "}";
+            first = false;
+        }
+        out << "\n]}\n";
+    }
+
+    bool writeChromeTrace(const std::string &path) const
+    {
+        std::ofstream out(path);
+        writeChromeTrace(out);
+        return static_cast<bool>(out);
+    }
+
+private:
+    Profiler():
+        _epoch(std::chrono::steady_clock::now())
+    {
+
+    }
+
+    static ZoneRing *&localRing() noexcept
+    {
+        thread_local ZoneRing *ring = nullptr;
+        return ring;
+    }
+
+    static std::string &localName()
+    {
+        thread_local std::string name;
+        return name;
+    }
+
+    ZoneRing *registerThread()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::uint32_t thread = static_cast<std::uint32_t>(_rings.size());
+        _rings.emplace_back(new ZoneRing(thread, localName().empty() ? "thread " + std::to_string(thread) : localName()));
+        return _rings.back().get();
+    }
+
+    static std::string escaped(const std::string &text)
+    {
+        std::string result;
+        for (char c: text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result;
+    }
+
+    // Trace timestamps are microseconds; keep the nanoseconds as three decimals.
+    static std::string microseconds(std::uint64_t nanoseconds)
+    {
+        std::string fraction = std::to_string(1000 + nanoseconds % 1000).substr(1);
+        return std::to_string(nanoseconds / 1000) + "." + fraction;
+    }
+
+    std::chrono::steady_clock::time_point _epoch;
+    std::atomic<bool> _enabled{false};
+    mutable std::mutex _mutex;
+    std::vector<std::unique_ptr<ZoneRing>> _rings;
+    std::vector<std::uint64_t> _drained;
+};
+
+// Times the enclosing scope into the calling thread's ring while the profiler is enabled.
+// A thread's first zone while enabled allocates its ring, which can throw bad_alloc.
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char *name):
+        _name(name)
+    {
+        Profiler &profiler = Profiler::instance();
+        if (profiler.enabled())
+        {
+            _ring = &profiler.threadRing();
+            _depth = _ring->enter();
+            _start = profiler.now();
+        }
+    }
+
+    ~ProfileZone()
+    {
+        if (_ring)
+        {
+            _ring->leave(_name, _start, Profiler::instance().now(), _depth);
+        }
+    }
+
+    ProfileZone(const ProfileZone &) = delete;
+    ProfileZone &operator=(const ProfileZone &) = delete;
+
+private:
+    const char *_name;
+    ZoneRing *_ring = nullptr;
+    std::uint64_t _start = 0;
+    std::uint32_t _depth = 0;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// PROFILE_ZONE("name") times the rest of the enclosing scope. The name must be a string
+// literal: records keep the pointer.
+#if PROFILER_ENABLED
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
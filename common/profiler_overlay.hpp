@@ -0,0 +1,231 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "profiler.hpp"
+
+// Frames averaged per stage.
+constexpr std::size_t OVERLAY_FRAMES = 60;
+// Screen pixels per font pixel; glyphs are 3x5 font pixels.
+constexpr float OVERLAY_PIXEL = 2.0f;
+// Characters in a row's name and timing columns, left of the bar.
+constexpr std::size_t OVERLAY_COLUMNS = 28;
+constexpr float OVERLAY_BAR_PIXELS_PER_MS = 12.0f;
+constexpr float OVERLAY_FRAME_BUDGET_MS = 1000.0f / 60.0f;
+
+// Rolling per-stage times drawn over the frame: one row per zone name with its mean and
+// worst time over the last OVERLAY_FRAMES frames, and a bar against a 60 Hz budget line.
+// Zones recorded by worker threads are summed, so parallel stages show CPU time.
+// F1 toggles the overlay together with recording; F2 writes the recorded zones to the
+// trace path as Chrome trace JSON. Construct it on the thread that owns the window, which
+// traces then call main.
+class ProfilerOverlay
+{
+public:
+    explicit ProfilerOverlay(const std::string &tracePath):
+        _tracePath(tracePath)
+    {
+        Profiler::instance().nameThread("main");
+    }
+
+    bool visible() const noexcept
+    {
+        return _visible;
+    }
+
+    // Returns true when the event was one of the overlay's keys.
+    bool handleEvent(const sf::Event &event)
+    {
+        if (event.type != sf::Event::KeyPressed)
+        {
+            return false;
+        }
+        if (event.key.code == sf::Keyboard::F1)
+        {
+            _visible = !_visible;
+            Profiler::instance().setEnabled(_visible);
+            return true;
+        }
+        if (event.key.code == sf::Keyboard::F2)
+        {
+            if (Profiler::instance().writeChromeTrace(_tracePath))
+            {
+                std::cerr << "Wrote profiler trace to " << _tracePath << std::endl;
+            }
+            else
+            {
+                std::cerr << "Failed to write profiler trace to " << _tracePath << std::endl;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // Folds the zones finished since the previous call into the current frame's slot.
+    // Call once per frame, after display().
+    void update()
+    {
+        if (!_visible)
+        {
+            return;
+        }
+
+        _records.clear();
+        Profiler::instance().drain(_records);
+
+        std::size_t slot = _frame % OVERLAY_FRAMES;
+        for (auto &stage: _stages)
+        {
+            stage.milliseconds[slot] = 0.0f;
+        }
+        for (const auto &record: _records)
+        {
+            stageFor(record.name).milliseconds[slot] += (record.end - record.start) / 1e6f;
+        }
+        ++_frame;
+    }
+
+    void draw(sf::RenderTarget &target)
+    {
+        if (!_visible)
+        {
+            return;
+        }
+
+        sf::View previous = target.getView();
+        sf::Vector2u size = target.getSize();
+        target.setView(sf::View(sf::FloatRect(0.0f, 0.0f, static_cast<float>(size.x), static_cast<float>(size.y))));
+
+        const float rowHeight = 7.0f * OVERLAY_PIXEL;
+        const float barLeft = 8.0f + OVERLAY_COLUMNS * 4.0f * OVERLAY_PIXEL;
+        const float budgetRight = barLeft + OVERLAY_FRAME_BUDGET_MS * OVERLAY_BAR_PIXELS_PER_MS;
+        std::size_t frames = std::min(_frame, OVERLAY_FRAMES);
+
+        _quads.clear();
+        addQuad(4.0f, 4.0f, budgetRight + 8.0f, 8.0f + rowHeight * (_stages.size() + 1), sf::Color(0, 0, 0, 170));
+        char row[64];
+        std::snprintf(row, sizeof(row), "%-14s %6s %5s", "STAGE", "MEAN", "MAX");
+        addText(8.0f, 8.0f, row, sf::Color::White);
+
+        float y = 8.0f + rowHeight;
+        for (const auto &stage: _stages)
+        {
+            float sum = 0.0f, worst = 0.0f;
+            for (std::size_t f = 0; f < frames; ++f)
+            {
+                sum += stage.milliseconds[f];
+                worst = std::max(worst, stage.milliseconds[f]);
+            }
+            float mean = frames > 0 ? sum / frames : 0.0f;
+
+            std::snprintf(row, sizeof(row), "%-14.14s %6.2f %5.1f", stage.name, mean, worst);
+            addText(8.0f, y, row, sf::Color::White);
+
+            float width = std::min(mean * OVERLAY_BAR_PIXELS_PER_MS, budgetRight - barLeft);
+            addQuad(barLeft, y, width, 5.0f * OVERLAY_PIXEL, stage.color);
+            y += rowHeight;
+        }
+        addQuad(budgetRight, 8.0f, 1.0f, y - 8.0f, sf::Color::Red);
+
+        target.draw(_quads);
+        target.setView(previous);
+    }
+
+private:
+    struct Stage
+    {
+        const char *name;
+        sf::Color color;
+        float milliseconds[OVERLAY_FRAMES];
+    };
+
+    struct Glyph
+    {
+        char character;
+        // Five rows of three bits, top row in the high bits.
+        std::uint16_t rows;
+    };
+
+    Stage &stageFor(const char *name)
+    {
+        for (auto &stage: _stages)
+        {
+            if (stage.name == name || std::strcmp(stage.name, name) == 0)
+            {
+                return stage;
+            }
+        }
+
+        static const sf::Color PALETTE[] =
+        {
+            sf::Color(230, 159, 0), sf::Color(86, 180, 233), sf::Color(0, 158, 115), sf::Color(240, 228, 66),
+            sf::Color(0, 114, 178), sf::Color(213, 94, 0), sf::Color(204, 121, 167), sf::Color(160, 160, 160)
+        };
+        Stage stage = {name, PALETTE[_stages.size() % 8], {}};
+        _stages.push_back(stage);
+        return _stages.back();
+    }
+
+    void addQuad(float x, float y, float width, float height, const sf::Color &color)
+    {
+        _quads.append(sf::Vertex(sf::Vector2f(x, y), color));
+        _quads.append(sf::Vertex(sf::Vector2f(x + width, y), color));
+        _quads.append(sf::Vertex(sf::Vector2f(x + width, y + height), color));
+        _quads.append(sf::Vertex(sf::Vector2f(x, y + height), color));
+    }
+
+    void addText(float x, float y, const char *text, const sf::Color &color)
+    {
+        for (; *text; ++text, x += 4.0f * OVERLAY_PIXEL)
+        {
+            std::uint16_t rows = glyph(static_cast<char>(std::toupper(static_cast<unsigned char>(*text))));
+            for (int bit = 0; bit < 15; ++bit)
+            {
+                if (rows & (1 << (14 - bit)))
+                {
+                    addQuad(x + (bit % 3) * OVERLAY_PIXEL, y + (bit / 3) * OVERLAY_PIXEL, OVERLAY_PIXEL, OVERLAY_PIXEL, color);
+                }
+            }
+        }
+    }
+
+    // Unknown characters draw as blanks.
+    static std::uint16_t glyph(char character)
+    {
+        static const Glyph FONT[] =
+        {
+            {'0', 0x7B6F}, {'1', 0x2C97}, {'2', 0x73E7}, {'3', 0x73CF}, {'4', 0x5BC9},
+            {'5', 0x79CF}, {'6', 0x79EF}, {'7', 0x7249}, {'8', 0x7BEF}, {'9', 0x7BCF},
+            {'A', 0x2BED}, {'B', 0x6BAE}, {'C', 0x3923}, {'D', 0x6B6E}, {'E', 0x79A7},
+            {'F', 0x79A4}, {'G', 0x396B}, {'H', 0x5BED}, {'I', 0x7497}, {'J', 0x126A},
+            {'K', 0x5BAD}, {'L', 0x4927}, {'M', 0x5FED}, {'N', 0x6B6D}, {'O', 0x2B6A},
+            {'P', 0x6BA4}, {'Q', 0x2B73}, {'R', 0x6BAD}, {'S', 0x388E}, {'T', 0x7492},
+            {'U', 0x5B6F}, {'V', 0x5B6A}, {'W', 0x5BFD}, {'X', 0x5AAD}, {'Y', 0x5A92},
+            {'Z', 0x72A7}, {'.', 0x0002}, {':', 0x0410}, {'-', 0x01C0}, {'/', 0x12A4},
+            {'(', 0x1491}, {')', 0x4494}, {'+', 0x05D0}, {'_', 0x0007}
+        };
+        for (const auto &entry: FONT)
+        {
+            if (entry.character == character)
+            {
+                return entry.rows;
+            }
+        }
+        return 0;
+    }
+
+    std::string _tracePath;
+    bool _visible = false;
+    std::size_t _frame = 0;
+    std::vector<Stage> _stages;
+    std::vector<ZoneRecord> _records;
+    sf::VertexArray _quads{sf::Quads};
+};
@@ -0,0 +1,430 @@
+#pragma once
+
+#include <cmath>
+#include <type_traits>
+
+// Small vector, matrix and quaternion types shared by the labs. Vectors are plain floats
+// so they stay constexpr and match sf::Vector2f / sf::Vector3f in layout. Everything here
+// is scalar: one 4x4 product or one reciprocal square root is too little work for SSE to
+// pay for its shuffles, and math_bench measured the intrinsics slower than this code. The
+// SIMD work is in the batch kernels of batch_math.hpp.
+// Every vector type converts from any type with the same x, y (and z) members, so
+// SFML vectors can be passed straight in; as<V>() converts back.
+
+// 1 / sqrt(value). A single rsqrtss estimate plus a Newton-Raphson step measured slower
+// than the sqrt and divide here; normalizeVectors uses the estimate, four or eight at a
+// time, where it does win.
+inline float fastInverseSqrt(float value) noexcept
+{
+    return 1.0f / std::sqrt(value);
+}
+
+// Member detection for the converting constructors, so that a vec2 is never built from a
+// 3D vector or a vec3 from a 4D one.
+template <typename V, typename = void>
+struct hasMemberZ: std::false_type {};
+
+template <typename V>
+struct hasMemberZ<V, decltype(void(V::z))>: std::true_type {};
+
+template <typename V, typename = void>
+struct hasMemberW: std::false_type {};
+
+template <typename V>
+struct hasMemberW<V, decltype(void(V::w))>: std::true_type {};
+
+struct vec2
+{
+    float x, y;
+
+    constexpr vec2(float x = 0.0f, float y = 0.0f):
+        x(x), y(y)
+    {
+
+    }
+
+    template <typename V, typename = decltype(V::y), typename = typename std::enable_if<!hasMemberZ<V>::value>::type>
+    constexpr vec2(const V &v):
+        x(v.x), y(v.y)
+    {
+
+    }
+
+    template <typename V>
+    V as() const
+    {
+        return V(x, y);
+    }
+
+    constexpr vec2 operator+(const vec2 &v) const { return vec2(x + v.x, y + v.y); }
+    constexpr vec2 operator-(const vec2 &v) const { return vec2(x - v.x, y - v.y); }
+    constexpr vec2 operator-() const { return vec2(-x, -y); }
+    constexpr vec2 operator*(float f) const { return vec2(x * f, y * f); }
+    constexpr vec2 operator/(float f) const { return vec2(x / f, y / f); }
+
+    constexpr float dot(const vec2 &v) const
+    {
+        return x * v.x + y * v.y;
+    }
+
+    float length() const
+    {
+        return std::sqrt(dot(*this));
+    }
+
+    vec2 normalize() const
+    {
+        return *this / length();
+    }
+
+    vec2 fastNormalize() const
+    {
+        return *this * fastInverseSqrt(dot(*this));
+    }
+};
+
+struct vec3
+{
+    float x, y, z;
+
+    constexpr vec3(float x = 0.0f, float y = 0.0f, float z = 0.0f):
+        x(x), y(y), z(z)
+    {
+
+    }
+
+    template <typename V, typename = decltype(V::z), typename = typename std::enable_if<!hasMemberW<V>::value>::type>
+    constexpr vec3(const V &v):
+        x(v.x), y(v.y), z(v.z)
+    {
+
+    }
+
+    template <typename V>
+    V as() const
+    {
+        return V(x, y, z);
+    }
+
+    constexpr vec3 operator+(const vec3 &v) const { return vec3(x + v.x, y + v.y, z + v.z); }
+    constexpr vec3 operator-(const vec3 &v) const { return vec3(x - v.x, y - v.y, z - v.z); }
+    constexpr vec3 operator-() const { return vec3(-x, -y, -z); }
+    constexpr vec3 operator*(float f) const { return vec3(x * f, y * f, z * f); }
+    constexpr vec3 operator/(float f) const { return vec3(x / f, y / f, z / f); }
+
+    vec3 &operator+=(const vec3 &v) noexcept
+    {
+        x += v.x;
+        y += v.y;
+        z += v.z;
+        return *this;
+    }
+
+    constexpr float dot(const vec3 &v) const
+    {
+        return x * v.x + y * v.y + z * v.z;
+    }
+
+    constexpr vec3 cross(const vec3 &v) const
+    {
+        return vec3(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x);
+    }
+
+    float length() const
+    {
+        return std::sqrt(dot(*this));
+    }
+
+    // Divides by the exact length, as the labs always have.
+    vec3 normalize() const
+    {
+        return *this / length();
+    }
+
+    vec3 fastNormalize() const
+    {
+        return *this * fastInverseSqrt(dot(*this));
+    }
+};
+
+struct vec4
+{
+    float x, y, z, w;
+
+    constexpr vec4(float x = 0.0f, float y = 0.0f, float z = 0.0f, float w = 0.0f):
+        x(x), y(y), z(z), w(w)
+    {
+
+    }
+
+    constexpr vec4(const vec3 &v, float w):
+        x(v.x), y(v.y), z(v.z), w(w)
+    {
+
+    }
+
+    constexpr vec3 xyz() const
+    {
+        return vec3(x, y, z);
+    }
+
+    constexpr vec4 operator+(const vec4 &v) const { return vec4(x + v.x, y + v.y, z + v.z, w + v.w); }
+    constexpr vec4 operator-(const vec4 &v) const { return vec4(x - v.x, y - v.y, z - v.z, w - v.w); }
+    constexpr vec4 operator*(float f) const { return vec4(x * f, y * f, z * f, w * f); }
+    constexpr vec4 operator/(float f) const { return vec4(x / f, y / f, z / f, w / f); }
+
+    constexpr float dot(const vec4 &v) const
+    {
+        return x * v.x + y * v.y + z * v.z + w * v.w;
+    }
+};
+
+constexpr vec2 operator*(float f, const vec2 &v) { return v * f; }
+constexpr vec3 operator*(float f, const vec3 &v) { return v * f; }
+constexpr vec4 operator*(float f, const vec4 &v) { return v * f; }
+
+constexpr float dot(const vec2 &a, const vec2 &b) { return a.dot(b); }
+constexpr float dot(const vec3 &a, const vec3 &b) { return a.dot(b); }
+constexpr float dot(const vec4 &a, const vec4 &b) { return a.dot(b); }
+constexpr vec3 cross(const vec3 &a, const vec3 &b) { return a.cross(b); }
+
+inline vec3 normalize(const vec3 &v) { return v.normalize(); }
+inline vec3 fastNormalize(const vec3 &v) { return v.fastNormalize(); }
+
+// Row-major 3x3 matrix acting on column vectors: v' = M * v.
+struct mat3
+{
+    float m[9];
+
+    static constexpr mat3 identity()
+    {
+        return {{
+            1.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f,
+            0.0f, 0.0f, 1.0f
+        }};
+    }
+
+    static mat3 rotationX(float angle) noexcept
+    {
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+        return {{
+            1.0f, 0.0f, 0.0f,
+            0.0f,    c,   -s,
+            0.0f,    s,    c
+        }};
+    }
+
+    static mat3 rotationY(float angle) noexcept
+    {
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+        return {{
+               c, 0.0f,    s,
+            0.0f, 1.0f, 0.0f,
+              -s, 0.0f,    c
+        }};
+    }
+
+    static mat3 rotationZ(float angle) noexcept
+    {
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+        return {{
+               c,   -s, 0.0f,
+               s,    c, 0.0f,
+            0.0f, 0.0f, 1.0f
+        }};
+    }
+
+    constexpr vec3 operator*(const vec3 &v) const
+    {
+        return vec3(m[0] * v.x + m[1] * v.y + m[2] * v.z,
+                    m[3] * v.x + m[4] * v.y + m[5] * v.z,
+                    m[6] * v.x + m[7] * v.y + m[8] * v.z);
+    }
+
+    mat3 operator*(const mat3 &other) const noexcept
+    {
+        mat3 result;
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int col = 0; col < 3; ++col)
+            {
+                result.m[row * 3 + col] = m[row * 3] * other.m[col] + m[row * 3 + 1] * other.m[3 + col] + m[row * 3 + 2] * other.m[6 + col];
+            }
+        }
+        return result;
+    }
+
+    constexpr mat3 transpose() const
+    {
+        return {{m[0], m[3], m[6], m[1], m[4], m[7], m[2], m[5], m[8]}};
+    }
+};
+
+// Row-major 4x4 matrix acting on column vectors: p' = M * p.
+struct mat4
+{
+    float m[16];
+
+    static constexpr mat4 identity()
+    {
+        return {{
+            1.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f
+        }};
+    }
+
+    static constexpr mat4 translation(const vec3 &offset)
+    {
+        return {{
+            1.0f, 0.0f, 0.0f, offset.x,
+            0.0f, 1.0f, 0.0f, offset.y,
+            0.0f, 0.0f, 1.0f, offset.z,
+            0.0f, 0.0f, 0.0f, 1.0f
+        }};
+    }
+
+    // The rotation part of a 3x3 matrix, with no translation.
+    static constexpr mat4 fromMat3(const mat3 &r)
+    {
+        return {{
+            r.m[0], r.m[1], r.m[2], 0.0f,
+            r.m[3], r.m[4], r.m[5], 0.0f,
+            r.m[6], r.m[7], r.m[8], 0.0f,
+            0.0f,   0.0f,   0.0f,   1.0f
+        }};
+    }
+
+    static mat4 rotationX(float angle) noexcept
+    {
+        return fromMat3(mat3::rotationX(angle));
+    }
+
+    static mat4 rotationY(float angle) noexcept
+    {
+        return fromMat3(mat3::rotationY(angle));
+    }
+
+    static mat4 rotationZ(float angle) noexcept
+    {
+        return fromMat3(mat3::rotationZ(angle));
+    }
+
+    // The labs' pinhole projection: screen = view.xy * fov / (view.z + fov), scaled by the
+    // aspect ratio on x and centred on the screen. The z row keeps the undivided view depth
+    // and w carries (view.z + fov), so dividing x and y by w yields pixel coordinates.
+    static mat4 projection(float fov, int screenWidth, int screenHeight) noexcept
+    {
+        float aspectRatio = static_cast<float>(screenWidth) / screenHeight;
+        float halfWidth = screenWidth / 2;
+        float halfHeight = screenHeight / 2;
+        return {{
+            fov * aspectRatio, 0.0f, halfWidth,  halfWidth * fov,
+            0.0f,               fov, halfHeight, halfHeight * fov,
+            0.0f,              0.0f, 1.0f,       0.0f,
+            0.0f,              0.0f, 1.0f,       fov
+        }};
+    }
+
+    mat4 operator*(const mat4 &other) const noexcept
+    {
+        mat4 result;
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                float sum = 0.0f;
+                for (int k = 0; k < 4; ++k)
+                {
+                    sum += m[row * 4 + k] * other.m[k * 4 + col];
+                }
+                result.m[row * 4 + col] = sum;
+            }
+        }
+        return result;
+    }
+
+    vec4 operator*(const vec4 &v) const noexcept
+    {
+        return vec4(m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3] * v.w,
+                    m[4] * v.x + m[5] * v.y + m[6] * v.z + m[7] * v.w,
+                    m[8] * v.x + m[9] * v.y + m[10] * v.z + m[11] * v.w,
+                    m[12] * v.x + m[13] * v.y + m[14] * v.z + m[15] * v.w);
+    }
+
+    // M * (p, 1) without the bottom row, as transformPoints computes it.
+    constexpr vec3 transformPoint(const vec3 &p) const
+    {
+        return vec3(m[0] * p.x + m[1] * p.y + m[2] * p.z + m[3],
+                    m[4] * p.x + m[5] * p.y + m[6] * p.z + m[7],
+                    m[8] * p.x + m[9] * p.y + m[10] * p.z + m[11]);
+    }
+
+    // x and y divided by w, and the undivided third row, as projectPoints computes them.
+    vec3 projectPoint(const vec3 &p) const noexcept
+    {
+        float wInv = 1.0f / (m[12] * p.x + m[13] * p.y + m[14] * p.z + m[15]);
+        return vec3((m[0] * p.x + m[1] * p.y + m[2] * p.z + m[3]) * wInv,
+                    (m[4] * p.x + m[5] * p.y + m[6] * p.z + m[7]) * wInv,
+                    m[8] * p.x + m[9] * p.y + m[10] * p.z + m[11]);
+    }
+};
+
+// Unit quaternions for rotations: w + xi + yj + zk.
+struct quat
+{
+    float w, x, y, z;
+
+    constexpr quat(float w = 1.0f, float x = 0.0f, float y = 0.0f, float z = 0.0f):
+        w(w), x(x), y(y), z(z)
+    {
+
+    }
+
+    // Rotation by angle radians about a unit axis.
+    static quat fromAxisAngle(const vec3 &axis, float angle) noexcept
+    {
+        float s = std::sin(angle * 0.5f);
+        return quat(std::cos(angle * 0.5f), axis.x * s, axis.y * s, axis.z * s);
+    }
+
+    // Applies other first, then this.
+    constexpr quat operator*(const quat &other) const
+    {
+        return quat(w * other.w - x * other.x - y * other.y - z * other.z,
+                    w * other.x + x * other.w + y * other.z - z * other.y,
+                    w * other.y - x * other.z + y * other.w + z * other.x,
+                    w * other.z + x * other.y - y * other.x + z * other.w);
+    }
+
+    constexpr quat conjugate() const
+    {
+        return quat(w, -x, -y, -z);
+    }
+
+    quat normalize() const noexcept
+    {
+        float inverse = fastInverseSqrt(w * w + x * x + y * y + z * z);
+        return quat(w * inverse, x * inverse, y * inverse, z * inverse);
+    }
+
+    // v + 2w (q x v) + 2 q x (q x v), with q the vector part.
+    constexpr vec3 rotate(const vec3 &v) const
+    {
+        return v + vec3(x, y, z).cross(v) * (2.0f * w) + vec3(x, y, z).cross(vec3(x, y, z).cross(v)) * 2.0f;
+    }
+
+    constexpr mat3 toMat3() const
+    {
+        return {{
+            1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - w * z),        2.0f * (x * z + w * y),
+            2.0f * (x * y + w * z),        1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - w * x),
+            2.0f * (x * z - w * y),        2.0f * (y * z + w * x),        1.0f - 2.0f * (x * x + y * y)
+        }};
+    }
+};
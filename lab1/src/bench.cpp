@@ -0,0 +1,495 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "bench_timing.hpp"
+#include "bezier.hpp"
+#include "curve_batch.hpp"
+#include "curve_picking.hpp"
+
+namespace
+{
+    constexpr std::size_t CURVE_POINTS = 1000;
+    constexpr float SCREEN_WIDTH = 800.0f;
+    constexpr float SCREEN_HEIGHT = 600.0f;
+
+    // The evaluator lab1 used before bezier.hpp: a tgamma binomial and two pow calls per
+    // control point per sample.
+    template<std::size_t Size>
+    point referenceEvaluateBezier(float t, const point_array<Size> &controlPoints) noexcept
+    {
+        auto x = 0.0f, y = 0.0f;
+        auto n = controlPoints.size() - 1;
+        for (std::size_t i = 0; i <= n; ++i)
+        {
+            float blend = std::pow(1 - t, n - i) * std::pow(t, i) *
+                          (std::tgamma(n + 1) / (std::tgamma(i + 1) * std::tgamma(n - i + 1)));
+            x += controlPoints[i].first * blend;
+            y += controlPoints[i].second * blend;
+        }
+        return std::make_pair(x, y);
+    }
+
+    // de Casteljau in long double, as the accuracy reference.
+    point exactPoint(double t, const std::vector<point> &controlPoints)
+    {
+        std::vector<long double> x, y;
+        for (const auto &controlPoint: controlPoints)
+        {
+            x.push_back(controlPoint.first);
+            y.push_back(controlPoint.second);
+        }
+        for (std::size_t level = 1; level < controlPoints.size(); ++level)
+        {
+            for (std::size_t i = 0; i + level < controlPoints.size(); ++i)
+            {
+                x[i] = x[i] * (1 - t) + x[i + 1] * t;
+                y[i] = y[i] * (1 - t) + y[i + 1] * t;
+            }
+        }
+        return {static_cast<float>(x[0]), static_cast<float>(y[0])};
+    }
+
+    float maxError(const std::vector<point> &samples, const std::vector<point> &controlPoints)
+    {
+        float error = 0.0f;
+        for (std::size_t i = 0; i < samples.size(); ++i)
+        {
+            point exact = exactPoint(static_cast<double>(i) / (samples.size() - 1), controlPoints);
+            error = std::max({error, std::abs(samples[i].first - exact.first), std::abs(samples[i].second - exact.second)});
+        }
+        return error;
+    }
+
+    // Largest pixel distance from the curve, sampled densely, to the nearest segment of the
+    // polyline.
+    float polylineDeviation(const BezierCurve<> &curve, const std::vector<point> &polyline, const point &pixelScale)
+    {
+        float worst = 0.0f;
+        for (int i = 0; i <= 20000; ++i)
+        {
+            point onCurve = curve.evaluate(i / 20000.0f);
+            float px = onCurve.first * pixelScale.first, py = onCurve.second * pixelScale.second;
+            float nearest = std::numeric_limits<float>::max();
+            for (std::size_t j = 0; j + 1 < polyline.size(); ++j)
+            {
+                float ax = polyline[j].first * pixelScale.first, ay = polyline[j].second * pixelScale.second;
+                float bx = polyline[j + 1].first * pixelScale.first, by = polyline[j + 1].second * pixelScale.second;
+                float abx = bx - ax, aby = by - ay;
+                float length = abx * abx + aby * aby;
+                float t = length > 0.0f ? std::min(std::max(((px - ax) * abx + (py - ay) * aby) / length, 0.0f), 1.0f) : 0.0f;
+                float dx = ax + abx * t - px, dy = ay + aby * t - py;
+                nearest = std::min(nearest, dx * dx + dy * dy);
+            }
+            worst = std::max(worst, std::sqrt(nearest));
+        }
+        return worst;
+    }
+
+    // Vertex counts of the adaptive polyline at several pixel tolerances next to the fixed
+    // CURVE_POINTS samples, on an 800x600 window.
+    void reportFlattening(const char *name, const std::vector<point> &controlPoints)
+    {
+        const point pixelScale = {SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.5f};
+        BezierCurve<> curve(controlPoints);
+        std::vector<point> fixed = curve.sample(CURVE_POINTS);
+        std::printf("%s: fixed %zu vertices, deviation %.3f px\n", name, fixed.size(), polylineDeviation(curve, fixed, pixelScale));
+
+        for (float tolerance: {0.1f, 0.25f, 0.5f, 1.0f})
+        {
+            std::vector<point> polyline;
+            double time = measureNanoseconds([&]
+            {
+                curve.flatten(tolerance, pixelScale, polyline);
+            }, 200);
+            std::printf("    tolerance %.2f px: %4zu vertices, deviation %.3f px, %.1f us\n",
+                        tolerance, polyline.size(), polylineDeviation(curve, polyline, pixelScale), time / 1e3);
+        }
+    }
+
+    // A cubic whose control points all lie on one line but overshoot the chord: the curve
+    // runs well past both ends of it, so only distance to the chord segment, not the line,
+    // keeps it from flattening to a single segment. Returns false past the tolerance.
+    bool checkCollinearOvershoot(float tolerance)
+    {
+        const point pixelScale = {1.0f, 1.0f};
+        BezierCurve<> curve({{0.0f, 0.0f}, {1000.0f, 0.0f}, {-900.0f, 0.0f}, {100.0f, 0.0f}});
+        std::vector<point> polyline = curve.flatten(tolerance, pixelScale);
+        float deviation = polylineDeviation(curve, polyline, pixelScale);
+        bool passed = deviation <= tolerance * 1.01f;
+        std::printf("collinear overshoot cubic: tolerance %.2f px, %zu vertices, deviation %.3f px%s\n",
+                    tolerance, polyline.size(), deviation, passed ? "" : ", EXCEEDS TOLERANCE");
+        return passed;
+    }
+
+    // Marker steps of equal time along the curve: CURVE_POINTS equal steps in t as the marker
+    // used to take, then equal distances through the arc-length table. Speed variation is
+    // the longest step over the shortest on screen. Also times both distance queries and
+    // checks the distance reached against a dense polyline.
+    void reportArcLength(const char *name, const std::vector<point> &controlPoints)
+    {
+        const point pixelScale = {SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.5f};
+        BezierCurve<> curve(controlPoints);
+        ArcLengthTable table(curve, pixelScale);
+
+        auto stepRatio = [&](auto parameterOfStep)
+        {
+            float shortest = std::numeric_limits<float>::max(), longest = 0.0f;
+            point previous = curve.evaluate(parameterOfStep(0));
+            for (std::size_t i = 1; i < CURVE_POINTS; ++i)
+            {
+                point current = curve.evaluate(parameterOfStep(i));
+                float step = std::hypot((current.first - previous.first) * pixelScale.first, (current.second - previous.second) * pixelScale.second);
+                shortest = std::min(shortest, step);
+                longest = std::max(longest, step);
+                previous = current;
+            }
+            return longest / shortest;
+        };
+
+        float fixedRatio = stepRatio([](std::size_t i) { return static_cast<float>(i) / (CURVE_POINTS - 1); });
+        float arcRatio = stepRatio([&](std::size_t i) { return table.uniformParameterAt(table.length() * i / (CURVE_POINTS - 1)); });
+
+        std::vector<point> dense = curve.sample(100001);
+        std::vector<double> denseLengths(dense.size(), 0.0);
+        for (std::size_t i = 1; i < dense.size(); ++i)
+        {
+            denseLengths[i] = denseLengths[i - 1] + std::hypot((dense[i].first - dense[i - 1].first) * pixelScale.first,
+                                                               (dense[i].second - dense[i - 1].second) * pixelScale.second);
+        }
+        double worst = 0.0;
+        for (int i = 0; i <= 1000; ++i)
+        {
+            float distance = table.length() * i / 1000.0f;
+            double t = table.parameterAt(distance) * (dense.size() - 1);
+            std::size_t index = std::min(static_cast<std::size_t>(t), dense.size() - 2);
+            double reached = denseLengths[index] + (denseLengths[index + 1] - denseLengths[index]) * (t - index);
+            worst = std::max(worst, std::abs(reached - distance));
+        }
+
+        const std::size_t QUERIES = 1000000;
+        volatile float sink = 0.0f;
+        double searchTime = measureNanoseconds([&]
+        {
+            for (std::size_t i = 0; i < QUERIES; ++i)
+            {
+                sink = sink + table.parameterAt(table.length() * (i % 4096) / 4096.0f);
+            }
+        }, 5);
+        double uniformTime = measureNanoseconds([&]
+        {
+            for (std::size_t i = 0; i < QUERIES; ++i)
+            {
+                sink = sink + table.uniformParameterAt(table.length() * (i % 4096) / 4096.0f);
+            }
+        }, 5);
+        double buildTime = measureNanoseconds([&]
+        {
+            ArcLengthTable rebuilt(curve, pixelScale);
+            sink = sink + rebuilt.length();
+        }, 50);
+
+        std::printf("%s: length %.1f px, table build %.1f us, step spread fixed t %.2fx, arc length %.4fx, distance error %.1e px, "
+                    "query %.1f ns binary search, %.1f ns uniform\n",
+                    name, table.length(), buildTime / 1e3, fixedRatio, arcRatio, worst, searchTime / QUERIES, uniformTime / QUERIES);
+    }
+
+    // curveCount random cubics in SoA layout evaluated at 64 parameters each, against the old
+    // scalar evaluator and BezierCurve one curve at a time. Also checks the batch results
+    // against BezierCurve, a uniform B-spline end point and a rational quarter circle.
+    void benchmarkBatch(std::size_t curveCount)
+    {
+        const std::size_t DEGREE = 3;
+        const int PARAMETERS = 64;
+
+        std::mt19937 random(17);
+        std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> weight(0.5f, 2.0f);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        std::vector<float> x((DEGREE + 1) * curveCount), y(x.size()), weights(x.size()), t(curveCount);
+        std::vector<point_array<DEGREE + 1>> arrays(curveCount);
+        std::vector<BezierCurve<DEGREE>> curves;
+        for (std::size_t c = 0; c < curveCount; ++c)
+        {
+            for (std::size_t k = 0; k <= DEGREE; ++k)
+            {
+                x[k * curveCount + c] = coordinate(random);
+                y[k * curveCount + c] = coordinate(random);
+                weights[k * curveCount + c] = weight(random);
+                arrays[c][k] = {x[k * curveCount + c], y[k * curveCount + c]};
+            }
+            curves.emplace_back(arrays[c]);
+            t[c] = unit(random);
+        }
+
+        CurveBatch batch = {curveCount, x.data(), y.data()};
+        CurveBatch rationalBatch = {curveCount, x.data(), y.data(), weights.data()};
+        std::vector<float> outX(curveCount), outY(curveCount);
+        std::vector<point> outPoints(curveCount);
+
+        auto curvesPerSecond = [&](auto &&evaluateAll)
+        {
+            double time = measureNanoseconds([&]
+            {
+                for (int i = 0; i < PARAMETERS; ++i)
+                {
+                    evaluateAll(static_cast<float>(i) / (PARAMETERS - 1));
+                }
+            }, 10);
+            return curveCount * PARAMETERS / (time / 1e9);
+        };
+
+        double reference = curvesPerSecond([&](float parameter)
+        {
+            for (std::size_t c = 0; c < curveCount; ++c)
+            {
+                outPoints[c] = referenceEvaluateBezier(parameter, arrays[c]);
+            }
+        });
+        double single = curvesPerSecond([&](float parameter)
+        {
+            for (std::size_t c = 0; c < curveCount; ++c)
+            {
+                outPoints[c] = curves[c].evaluate(parameter);
+            }
+        });
+
+        BatchEvaluator bezier(SegmentBasis::Bezier, DEGREE);
+        BatchEvaluator bSpline(SegmentBasis::UniformBSpline, DEGREE);
+        BatchEvaluator scalarBezier(SegmentBasis::Bezier, DEGREE);
+        scalarBezier.disableAvx2();
+
+        double scalarShared = curvesPerSecond([&](float parameter) { scalarBezier.evaluate(batch, parameter, outX.data(), outY.data()); });
+        double scalarPerCurve = curvesPerSecond([&](float) { scalarBezier.evaluate(batch, t.data(), outX.data(), outY.data()); });
+        double shared = curvesPerSecond([&](float parameter) { bezier.evaluate(batch, parameter, outX.data(), outY.data()); });
+        double perCurve = curvesPerSecond([&](float) { bezier.evaluate(batch, t.data(), outX.data(), outY.data()); });
+        double bSplinePerCurve = curvesPerSecond([&](float) { bSpline.evaluate(batch, t.data(), outX.data(), outY.data()); });
+        double rationalPerCurve = curvesPerSecond([&](float) { bSpline.evaluate(rationalBatch, t.data(), outX.data(), outY.data()); });
+
+        float bezierError = 0.0f;
+        bezier.evaluate(batch, t.data(), outX.data(), outY.data());
+        for (std::size_t c = 0; c < curveCount; ++c)
+        {
+            point exact = curves[c].evaluate(t[c]);
+            bezierError = std::max({bezierError, std::abs(outX[c] - exact.first), std::abs(outY[c] - exact.second)});
+        }
+
+        // A uniform cubic B-spline segment starts at (P0 + 4 P1 + P2) / 6.
+        float bSplineError = 0.0f;
+        bSpline.evaluate(batch, 0.0f, outX.data(), outY.data());
+        for (std::size_t c = 0; c < curveCount; ++c)
+        {
+            float startX = (x[c] + 4.0f * x[curveCount + c] + x[2 * curveCount + c]) / 6.0f;
+            float startY = (y[c] + 4.0f * y[curveCount + c] + y[2 * curveCount + c]) / 6.0f;
+            bSplineError = std::max({bSplineError, std::abs(outX[c] - startX), std::abs(outY[c] - startY)});
+        }
+
+        // Rational quadratic Bezier with weights 1, sqrt(2) / 2, 1 traces a quarter circle.
+        const float circleX[] = {1.0f, 1.0f, 0.0f}, circleY[] = {0.0f, 1.0f, 1.0f}, circleWeights[] = {1.0f, std::sqrt(0.5f), 1.0f};
+        BatchEvaluator quadratic(SegmentBasis::Bezier, 2);
+        float circleError = 0.0f;
+        for (int i = 0; i <= 100; ++i)
+        {
+            float pointX, pointY;
+            quadratic.evaluate({1, circleX, circleY, circleWeights}, i / 100.0f, &pointX, &pointY);
+            circleError = std::max(circleError, std::abs(std::hypot(pointX, pointY) - 1.0f));
+        }
+
+        std::printf("%zu cubics x %d parameters, million curves per second (%s):\n", curveCount, PARAMETERS, bezier.usesAvx2() ? "AVX2 + FMA" : "no AVX2, scalar");
+        std::printf("    tgamma/pow evaluateBezier %8.1f\n    BezierCurve::evaluate     %8.1f\n", reference / 1e6, single / 1e6);
+        std::printf("    batch scalar shared t     %8.1f\n    batch scalar per-curve t  %8.1f\n", scalarShared / 1e6, scalarPerCurve / 1e6);
+        std::printf("    batch shared t            %8.1f (%.0fx evaluateBezier)\n    batch per-curve t         %8.1f (%.0fx)\n",
+                    shared / 1e6, shared / reference, perCurve / 1e6, perCurve / reference);
+        std::printf("    B-spline per-curve t      %8.1f\n    NURBS per-curve t         %8.1f\n", bSplinePerCurve / 1e6, rationalPerCurve / 1e6);
+        std::printf("    error vs BezierCurve %.1e, B-spline start %.1e, rational quarter circle radius %.1e\n", bezierError, bSplineError, circleError);
+    }
+
+    // Closest point on curveCount small cubics scattered over the window, in pixels: brute
+    // force over CURVE_POINTS samples of every curve against CurvePicker, per curve and over
+    // the whole set.
+    void benchmarkPicking(std::size_t curveCount, std::size_t queryCount)
+    {
+        std::mt19937 random(39);
+        std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> offset(-0.15f, 0.15f);
+        point scale = {SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.5f};
+
+        CurvePicker picker;
+        std::vector<std::vector<point>> samples;
+        for (std::size_t c = 0; c < curveCount; ++c)
+        {
+            point center = {coordinate(random), coordinate(random)};
+            point_array<4> controlPoints;
+            for (auto &controlPoint: controlPoints)
+            {
+                controlPoint = {center.first + offset(random), center.second + offset(random)};
+            }
+            BezierCurve<3> curve(controlPoints);
+            picker.add(curve, scale);
+
+            samples.push_back(curve.sample(CURVE_POINTS));
+            for (auto &sample: samples.back())
+            {
+                sample = {sample.first * scale.first, sample.second * scale.second};
+            }
+        }
+
+        std::vector<point> queries(queryCount);
+        for (auto &query: queries)
+        {
+            query = {coordinate(random) * scale.first, coordinate(random) * scale.second};
+        }
+
+        auto bruteForce = [&](std::size_t c, const point &query)
+        {
+            float best = std::numeric_limits<float>::max();
+            for (const auto &sample: samples[c])
+            {
+                float dx = sample.first - query.first, dy = sample.second - query.second;
+                best = std::min(best, dx * dx + dy * dy);
+            }
+            return std::sqrt(best);
+        };
+
+        float sink = 0.0f;
+        double bruteCurveTime = measureNanoseconds([&]
+        {
+            for (std::size_t q = 0; q < queryCount; ++q)
+            {
+                sink += bruteForce(q % curveCount, queries[q]);
+            }
+        }, 5) / queryCount;
+        double pickerCurveTime = measureNanoseconds([&]
+        {
+            for (std::size_t q = 0; q < queryCount; ++q)
+            {
+                sink += picker.closest(q % curveCount, queries[q]).distance;
+            }
+        }, 5) / queryCount;
+
+        const std::size_t SET_QUERIES = std::min<std::size_t>(queryCount, 100);
+        double bruteSetTime = measureNanoseconds([&]
+        {
+            for (std::size_t q = 0; q < SET_QUERIES; ++q)
+            {
+                float best = std::numeric_limits<float>::max();
+                for (std::size_t c = 0; c < curveCount; ++c)
+                {
+                    best = std::min(best, bruteForce(c, queries[q]));
+                }
+                sink += best;
+            }
+        }, 3) / SET_QUERIES;
+        double pickerSetTime = measureNanoseconds([&]
+        {
+            for (std::size_t q = 0; q < queryCount; ++q)
+            {
+                sink += picker.closest(queries[q]).distance;
+            }
+        }, 5) / queryCount;
+
+        // The picker refines on the exact curve, so it should never be farther than the
+        // nearest of the samples, and is usually a little nearer.
+        float worse = 0.0f, better = 0.0f;
+        for (std::size_t q = 0; q < queryCount; ++q)
+        {
+            std::size_t c = q % curveCount;
+            float difference = picker.closest(c, queries[q]).distance - bruteForce(c, queries[q]);
+            worse = std::max(worse, difference);
+            better = std::max(better, -difference);
+        }
+        std::size_t mismatches = 0;
+        for (std::size_t q = 0; q < SET_QUERIES; ++q)
+        {
+            float best = std::numeric_limits<float>::max();
+            for (std::size_t c = 0; c < curveCount; ++c)
+            {
+                best = std::min(best, bruteForce(c, queries[q]));
+            }
+            mismatches += picker.closest(queries[q]).distance > best + 1e-3f;
+        }
+
+        std::printf("closest point, %zu cubics, %zu queries (checksum %.0f):\n", curveCount, queryCount, sink);
+        std::printf("    one curve: %zu-sample search %8.1f ns, CurvePicker %6.1f ns (%.0fx); CurvePicker at most %.1e px farther, up to %.1e px nearer\n",
+                    CURVE_POINTS, bruteCurveTime, pickerCurveTime, bruteCurveTime / pickerCurveTime, worse, better);
+        std::printf("    all curves: %zu-sample search %8.1f us, CurvePicker %6.2f us (%.0fx, %.1f ns per curve), %zu of %zu queries farther than the search\n",
+                    CURVE_POINTS, bruteSetTime / 1e3, pickerSetTime / 1e3, bruteSetTime / pickerSetTime, pickerSetTime / curveCount, mismatches, SET_QUERIES);
+    }
+
+    // CURVE_POINTS samples of a random curve of the given degree: the old evaluator, one
+    // Bernstein/Horner evaluation per sample, and forward differencing with the degree fixed
+    // at compile time and at runtime.
+    template<std::size_t Degree>
+    void benchmarkDegree()
+    {
+        std::mt19937 random(static_cast<unsigned>(Degree));
+        std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+        point_array<Degree + 1> controlPoints;
+        for (auto &controlPoint: controlPoints)
+        {
+            controlPoint = {coordinate(random), coordinate(random)};
+        }
+        std::vector<point> dynamicControlPoints(controlPoints.begin(), controlPoints.end());
+
+        BezierCurve<Degree> curve(controlPoints);
+        BezierCurve<> dynamicCurve(dynamicControlPoints);
+        std::vector<point> reference(CURVE_POINTS), evaluated(CURVE_POINTS), fixed(CURVE_POINTS), dynamic(CURVE_POINTS);
+
+        double referenceTime = measureNanoseconds([&]
+        {
+            for (std::size_t i = 0; i < CURVE_POINTS; ++i)
+            {
+                reference[i] = referenceEvaluateBezier(static_cast<float>(i) / (CURVE_POINTS - 1), controlPoints);
+            }
+        }, 200);
+        double evaluateTime = measureNanoseconds([&]
+        {
+            for (std::size_t i = 0; i < CURVE_POINTS; ++i)
+            {
+                evaluated[i] = curve.evaluate(static_cast<float>(i) / (CURVE_POINTS - 1));
+            }
+        }, 200);
+        double fixedTime = measureNanoseconds([&]
+        {
+            curve.sample(fixed.data(), CURVE_POINTS);
+        }, 200);
+        double dynamicTime = measureNanoseconds([&]
+        {
+            dynamicCurve.sample(dynamic.data(), CURVE_POINTS);
+        }, 200);
+
+        std::printf("degree %2zu, %zu samples: tgamma/pow %8.1f us (error %.1e), Bernstein/Horner %6.1f us (error %.1e), "
+                    "forward differences %5.1f us compile-time degree, %5.1f us runtime degree (error %.1e), speedup %6.1fx\n",
+                    Degree, CURVE_POINTS, referenceTime / 1e3, maxError(reference, dynamicControlPoints),
+                    evaluateTime / 1e3, maxError(evaluated, dynamicControlPoints),
+                    fixedTime / 1e3, dynamicTime / 1e3, maxError(fixed, dynamicControlPoints), referenceTime / fixedTime);
+    }
+}
+
+int main()
+{
+    benchmarkDegree<3>();
+    benchmarkDegree<5>();
+    benchmarkDegree<10>();
+    benchmarkDegree<20>();
+    benchmarkDegree<32>();
+
+    reportFlattening("lab1 cubic", {{-0.8f, -0.5f}, {-0.2f, 0.8f}, {0.2f, -0.8f}, {0.8f, 0.5f}});
+    reportFlattening("cubic with a cusp", {{-0.8f, -0.6f}, {0.9f, 0.8f}, {-0.9f, 0.8f}, {0.8f, -0.6f}});
+    reportFlattening("near-straight cubic", {{-0.9f, 0.0f}, {-0.3f, 0.01f}, {0.3f, -0.01f}, {0.9f, 0.0f}});
+    bool flatteningOk = checkCollinearOvershoot(0.25f);
+    benchmarkBatch(10000);
+
+    reportArcLength("lab1 cubic", {{-0.8f, -0.5f}, {-0.2f, 0.8f}, {0.2f, -0.8f}, {0.8f, 0.5f}});
+    reportArcLength("cubic with a cusp", {{-0.8f, -0.6f}, {0.9f, 0.8f}, {-0.9f, 0.8f}, {0.8f, -0.6f}});
+    benchmarkPicking(1000, 10000);
+
+    reportFlattening("degree 10 wave", {{-0.9f, 0.0f}, {-0.7f, 0.9f}, {-0.5f, -0.9f}, {-0.3f, 0.9f}, {-0.1f, -0.9f}, {0.1f, 0.9f},
+                                        {0.3f, -0.9f}, {0.5f, 0.9f}, {0.7f, -0.9f}, {0.8f, 0.9f}, {0.9f, 0.0f}});
+
+    return flatteningOk ? 0 : 1;
+}
@@ -0,0 +1,414 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using point = std::pair<float, float>;
+
+template<typename std::size_t Size>
+using point_array = std::array<point, Size>;
+
+constexpr std::size_t MAX_BEZIER_DEGREE = 32;
+// Past this degree the power form loses too many digits to cancellation, and uniform
+// sampling evaluates every point in Bernstein form instead.
+constexpr std::size_t MAX_FORWARD_DIFFERENCE_DEGREE = 20;
+constexpr std::size_t DYNAMIC_DEGREE = std::numeric_limits<std::size_t>::max();
+
+// Pascal's triangle up to MAX_BEZIER_DEGREE, built by the compiler.
+struct BinomialTable
+{
+    std::uint64_t values[MAX_BEZIER_DEGREE + 1][MAX_BEZIER_DEGREE + 1];
+
+    constexpr std::uint64_t operator()(std::size_t n, std::size_t k) const
+    {
+        return values[n][k];
+    }
+};
+
+constexpr BinomialTable makeBinomialTable()
+{
+    BinomialTable table = {};
+    for (std::size_t n = 0; n <= MAX_BEZIER_DEGREE; ++n)
+    {
+        table.values[n][0] = 1;
+        for (std::size_t k = 1; k <= n; ++k)
+        {
+            table.values[n][k] = table.values[n - 1][k - 1] + (k < n ? table.values[n - 1][k] : 0);
+        }
+    }
+    return table;
+}
+
+constexpr BinomialTable BINOMIALS = makeBinomialTable();
+
+static_assert(BINOMIALS(3, 1) == 3 && BINOMIALS(10, 5) == 252 && BINOMIALS(32, 16) == 601080390, "binomial table");
+
+// k! * S(j, k), with S the Stirling numbers of the second kind: the k-th forward difference
+// of u^j at u = 0 for a unit step.
+struct DifferenceTable
+{
+    double values[MAX_BEZIER_DEGREE + 1][MAX_BEZIER_DEGREE + 1];
+
+    constexpr double operator()(std::size_t j, std::size_t k) const
+    {
+        return values[j][k];
+    }
+};
+
+constexpr DifferenceTable makeDifferenceTable()
+{
+    // From S(j, k) = k * S(j - 1, k) + S(j - 1, k - 1), multiplied through by k!.
+    DifferenceTable table = {};
+    table.values[0][0] = 1.0;
+    for (std::size_t j = 1; j <= MAX_BEZIER_DEGREE; ++j)
+    {
+        for (std::size_t k = 1; k <= j; ++k)
+        {
+            table.values[j][k] = k * (table.values[j - 1][k] + table.values[j - 1][k - 1]);
+        }
+    }
+    return table;
+}
+
+constexpr DifferenceTable DIFFERENCES = makeDifferenceTable();
+
+static_assert(DIFFERENCES(3, 1) == 1.0 && DIFFERENCES(3, 2) == 6.0 && DIFFERENCES(3, 3) == 6.0, "difference table");
+
+template<typename Element, std::size_t Degree>
+struct BezierStorage
+{
+    using type = std::array<Element, Degree + 1>;
+};
+
+template<typename Element>
+struct BezierStorage<Element, DYNAMIC_DEGREE>
+{
+    using type = std::vector<Element>;
+};
+
+// Bezier curve of any degree up to MAX_BEZIER_DEGREE. BezierCurve<3> keeps its points in a
+// std::array and lets the compiler unroll every loop; BezierCurve<> takes the degree from
+// the number of points at runtime.
+//
+// Single points are evaluated in Bernstein form with Horner's rule, which stays accurate at
+// high degree. Uniform sampling converts the curve to power form once and walks it with
+// forward differences, so each further sample costs Degree additions per coordinate (up to
+// MAX_FORWARD_DIFFERENCE_DEGREE).
+template<std::size_t Degree = DYNAMIC_DEGREE>
+class BezierCurve
+{
+public:
+    using storage = typename BezierStorage<point, Degree>::type;
+
+    static_assert(Degree == DYNAMIC_DEGREE || Degree <= MAX_BEZIER_DEGREE, "degree exceeds the binomial table");
+
+    explicit BezierCurve(const storage &controlPoints):
+        _controlPoints(controlPoints)
+    {
+        if (controlPoints.empty() || controlPoints.size() > MAX_BEZIER_DEGREE + 1)
+        {
+            throw std::invalid_argument("BezierCurve needs 1 to MAX_BEZIER_DEGREE + 1 control points");
+        }
+
+        std::size_t n = degree();
+        resize(_coefficients, n + 1);
+
+        // Power-form coefficients: a_k = C(n, k) * sum_i (-1)^(k - i) * C(k, i) * P_i.
+        for (std::size_t k = 0; k <= n; ++k)
+        {
+            double x = 0.0, y = 0.0;
+            for (std::size_t i = 0; i <= k; ++i)
+            {
+                double weight = static_cast<double>(BINOMIALS(k, i)) * ((k - i) % 2 == 0 ? 1.0 : -1.0);
+                x += weight * controlPoints[i].first;
+                y += weight * controlPoints[i].second;
+            }
+            _coefficients[k] = {x * BINOMIALS(n, k), y * BINOMIALS(n, k)};
+        }
+    }
+
+    std::size_t degree() const noexcept
+    {
+        return _controlPoints.size() - 1;
+    }
+
+    const storage &controlPoints() const noexcept
+    {
+        return _controlPoints;
+    }
+
+    // Sums C(n, i) * s^(n - i) * t^i * P_i with s = 1 - t by Horner's rule in t / s, or in
+    // s / t for the second half of the curve so the ratio never exceeds one.
+    point evaluate(float t) const noexcept
+    {
+        std::size_t n = degree();
+        bool mirrored = t > 0.5f;
+        float s = 1.0f - t;
+        float ratio = mirrored ? s / t : t / s;
+
+        float x = 0.0f, y = 0.0f;
+        for (std::size_t j = 0; j <= n; ++j)
+        {
+            std::size_t i = mirrored ? j : n - j;
+            float binomial = static_cast<float>(BINOMIALS(n, i));
+            x = x * ratio + binomial * _controlPoints[i].first;
+            y = y * ratio + binomial * _controlPoints[i].second;
+        }
+
+        float scale = 1.0f;
+        float base = mirrored ? t : s;
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            scale *= base;
+        }
+        return {x * scale, y * scale};
+    }
+
+    // Writes count points at t = 0, 1 / (count - 1), ..., 1.
+    void sample(point *output, std::size_t count) const noexcept
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        std::size_t n = degree();
+        double step = count > 1 ? 1.0 / (count - 1) : 0.0;
+        if (n > MAX_FORWARD_DIFFERENCE_DEGREE)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                output[i] = evaluate(static_cast<float>(i * step));
+            }
+            return;
+        }
+
+        // Differences of every order at t = 0, taken straight from the power form: with
+        // b_j = a_j * step^j, the k-th difference is sum_j b_j * k! * S(j, k). Subtracting
+        // neighbouring samples instead would lose most of the digits the walk later amplifies.
+        double dx[MAX_BEZIER_DEGREE + 1] = {}, dy[MAX_BEZIER_DEGREE + 1] = {};
+        double power = 1.0;
+        for (std::size_t j = 0; j <= n; ++j)
+        {
+            for (std::size_t k = 0; k <= j; ++k)
+            {
+                dx[k] += _coefficients[j].first * power * DIFFERENCES(j, k);
+                dy[k] += _coefficients[j].second * power * DIFFERENCES(j, k);
+            }
+            power *= step;
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            output[i] = {static_cast<float>(dx[0]), static_cast<float>(dy[0])};
+            for (std::size_t k = 0; k < n; ++k)
+            {
+                dx[k] += dx[k + 1];
+                dy[k] += dy[k + 1];
+            }
+        }
+
+        // The last sample is the end point exactly, whatever rounding the walk collected.
+        output[count - 1] = count > 1 ? _controlPoints[n] : _controlPoints[0];
+    }
+
+    template<std::size_t Count>
+    point_array<Count> sample() const noexcept
+    {
+        point_array<Count> result;
+        sample(result.data(), Count);
+        return result;
+    }
+
+    std::vector<point> sample(std::size_t count) const
+    {
+        std::vector<point> result(count);
+        sample(result.data(), count);
+        return result;
+    }
+
+    // Replaces output with a polyline that stays within tolerance pixels of the curve, where
+    // pixelScale converts curve units to pixels along each axis. Spans are split in half by
+    // de Casteljau until every control point lies within tolerance of the span's chord; the
+    // curve stays inside its control polygon, so the chord is then close enough.
+    void flatten(float tolerance, const point &pixelScale, std::vector<point> &output) const
+    {
+        point span[MAX_BEZIER_DEGREE + 1];
+        for (std::size_t i = 0; i <= degree(); ++i)
+        {
+            span[i] = {_controlPoints[i].first * pixelScale.first, _controlPoints[i].second * pixelScale.second};
+        }
+
+        output.clear();
+        output.push_back(_controlPoints[0]);
+        flattenSpan(span, degree(), tolerance * tolerance, pixelScale, 0, output);
+    }
+
+    std::vector<point> flatten(float tolerance, const point &pixelScale) const
+    {
+        std::vector<point> result;
+        flatten(tolerance, pixelScale, result);
+        return result;
+    }
+
+private:
+    storage _controlPoints;
+    // Power-form coefficients in double, since forward differencing adds up their rounding.
+    typename BezierStorage<std::pair<double, double>, Degree>::type _coefficients;
+
+    // Enough halvings to take a unit-length curve below a thousandth of a pixel.
+    static constexpr int MAX_FLATTEN_DEPTH = 24;
+
+    // Squared pixel distance from every interior control point to the chord segment. A point
+    // that projects past either end is measured to that end, so a control point in line with
+    // the chord but beyond it still counts as bent; a collapsed chord measures to its start.
+    static float flatness(const point *span, std::size_t n) noexcept
+    {
+        float chordX = span[n].first - span[0].first;
+        float chordY = span[n].second - span[0].second;
+        float chordLength = chordX * chordX + chordY * chordY;
+
+        float worst = 0.0f;
+        for (std::size_t i = 1; i < n; ++i)
+        {
+            float offsetX = span[i].first - span[0].first;
+            float offsetY = span[i].second - span[0].second;
+            float t = chordLength > 0.0f ? std::min(std::max((offsetX * chordX + offsetY * chordY) / chordLength, 0.0f), 1.0f) : 0.0f;
+            float distanceX = offsetX - chordX * t;
+            float distanceY = offsetY - chordY * t;
+            worst = std::max(worst, distanceX * distanceX + distanceY * distanceY);
+        }
+        return worst;
+    }
+
+    static void flattenSpan(const point *span, std::size_t n, float toleranceSquared, const point &pixelScale, int depth, std::vector<point> &output)
+    {
+        if (depth == MAX_FLATTEN_DEPTH || flatness(span, n) <= toleranceSquared)
+        {
+            output.push_back({span[n].first / pixelScale.first, span[n].second / pixelScale.second});
+            return;
+        }
+
+        // de Casteljau at t = 1/2: the left half takes the first point of every level, the
+        // right half the last point of every level.
+        point left[MAX_BEZIER_DEGREE + 1], right[MAX_BEZIER_DEGREE + 1], level[MAX_BEZIER_DEGREE + 1];
+        std::copy(span, span + n + 1, level);
+        for (std::size_t k = 0; k <= n; ++k)
+        {
+            left[k] = level[0];
+            right[n - k] = level[n - k];
+            for (std::size_t i = 0; i + k < n; ++i)
+            {
+                level[i] = {(level[i].first + level[i + 1].first) * 0.5f, (level[i].second + level[i + 1].second) * 0.5f};
+            }
+        }
+
+        flattenSpan(left, n, toleranceSquared, pixelScale, depth + 1, output);
+        flattenSpan(right, n, toleranceSquared, pixelScale, depth + 1, output);
+    }
+
+    template<typename Element, std::size_t Size>
+    static void resize(std::array<Element, Size> &, std::size_t)
+    {
+
+    }
+
+    template<typename Element>
+    static void resize(std::vector<Element> &elements, std::size_t size)
+    {
+        elements.resize(size);
+    }
+};
+
+constexpr std::size_t ARC_LENGTH_SAMPLES = 1024;
+
+// Cumulative arc length of a curve over samples + 1 points evenly spaced in t, built once
+// per curve. Lengths are measured after scaling each axis by scale, so passing the pixel
+// scale used for flatten gives distances on screen. parameterAt maps a distance along the curve back to t by binary search over
+// the table; uniformParameterAt does it in constant time from a second table of t resampled
+// at even distances. Both interpolate linearly between entries.
+class ArcLengthTable
+{
+public:
+    template<std::size_t Degree>
+    explicit ArcLengthTable(const BezierCurve<Degree> &curve, const point &scale = {1.0f, 1.0f}, std::size_t samples = ARC_LENGTH_SAMPLES)
+    {
+        samples = std::max<std::size_t>(samples, 1);
+        std::vector<point> points = curve.sample(samples + 1);
+
+        _lengths.resize(samples + 1);
+        double total = 0.0;
+        for (std::size_t i = 1; i <= samples; ++i)
+        {
+            double dx = (points[i].first - points[i - 1].first) * scale.first;
+            double dy = (points[i].second - points[i - 1].second) * scale.second;
+            total += std::sqrt(dx * dx + dy * dy);
+            _lengths[i] = static_cast<float>(total);
+        }
+
+        _uniform.resize(samples + 1);
+        std::size_t segment = 0;
+        for (std::size_t i = 0; i <= samples; ++i)
+        {
+            float distance = length() * i / samples;
+            while (segment + 1 < samples && _lengths[segment + 1] < distance)
+            {
+                ++segment;
+            }
+            _uniform[i] = parameterIn(segment, distance);
+        }
+    }
+
+    float length() const noexcept
+    {
+        return _lengths.back();
+    }
+
+    float parameterAt(float distance) const noexcept
+    {
+        distance = std::min(std::max(distance, 0.0f), length());
+        std::size_t upper = std::upper_bound(_lengths.begin() + 1, _lengths.end() - 1, distance) - _lengths.begin();
+        return parameterIn(upper - 1, distance);
+    }
+
+    float uniformParameterAt(float distance) const noexcept
+    {
+        if (length() <= 0.0f)
+        {
+            return 0.0f;
+        }
+
+        float position = std::min(std::max(distance / length(), 0.0f), 1.0f) * (_uniform.size() - 1);
+        std::size_t index = std::min(static_cast<std::size_t>(position), _uniform.size() - 2);
+        float fraction = position - index;
+        return _uniform[index] + (_uniform[index + 1] - _uniform[index]) * fraction;
+    }
+
+    // Inverse of parameterAt: the length of the curve from 0 to t.
+    float distanceAt(float t) const noexcept
+    {
+        float position = std::min(std::max(t, 0.0f), 1.0f) * (_lengths.size() - 1);
+        std::size_t index = std::min(static_cast<std::size_t>(position), _lengths.size() - 2);
+        float fraction = position - index;
+        return _lengths[index] + (_lengths[index + 1] - _lengths[index]) * fraction;
+    }
+
+private:
+    std::vector<float> _lengths;
+    std::vector<float> _uniform;
+
+    // t at the given distance, inside table segment [segment, segment + 1].
+    float parameterIn(std::size_t segment, float distance) const noexcept
+    {
+        float span = _lengths[segment + 1] - _lengths[segment];
+        float fraction = span > 0.0f ? std::min(std::max((distance - _lengths[segment]) / span, 0.0f), 1.0f) : 0.0f;
+        return (segment + fraction) / (_lengths.size() - 1);
+    }
+};
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+#include "bezier.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CURVE_BATCH_AVX2 1
+#endif
+
+// Batches stay in float and expand every basis into powers of t, which is accurate enough
+// at animation degrees but not much further.
+constexpr std::size_t MAX_BATCH_DEGREE = 7;
+
+enum class SegmentBasis
+{
+    Bezier,
+    // One segment of a uniform B-spline: n + 1 consecutive control points, t in [0, 1].
+    UniformBSpline
+};
+
+// Many curves of the evaluator's degree in structure-of-arrays layout: control point k of curve c is
+// at x[k * count + c] and y[k * count + c]. With weights set, every curve is rational (a
+// NURBS segment on uniform knots, or a rational Bezier curve) and weights[k * count + c]
+// weighs that control point.
+struct CurveBatch
+{
+    std::size_t count;
+    const float *x;
+    const float *y;
+    const float *weights = nullptr;
+};
+
+// Evaluates whole CurveBatches into caller-provided x and y buffers of count floats, either
+// at one parameter shared by every curve or at one parameter per curve. Neither call
+// allocates. Each basis is stored as a matrix taking powers of t to the n + 1 control point
+// weights; with a shared parameter those weights are computed once and each group of
+// curves costs n + 1 multiply-adds per coordinate. Uses AVX2 and FMA, eight curves at a
+// time, when the CPU has them and the scalar kernels otherwise.
+class BatchEvaluator
+{
+public:
+    BatchEvaluator(SegmentBasis basis, std::size_t degree):
+        _degree(degree)
+    {
+        if (degree > MAX_BATCH_DEGREE)
+        {
+            throw std::invalid_argument("BatchEvaluator supports degrees up to MAX_BATCH_DEGREE");
+        }
+
+        std::size_t n = degree;
+        for (std::size_t k = 0; k <= n; ++k)
+        {
+            for (std::size_t j = 0; j <= n; ++j)
+            {
+                _basis[k][j] = static_cast<float>(basis == SegmentBasis::Bezier ? bernsteinCoefficient(n, k, j) : bSplineCoefficient(n, k, j));
+            }
+        }
+
+#ifdef CURVE_BATCH_AVX2
+        _useAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    }
+
+    std::size_t degree() const noexcept
+    {
+        return _degree;
+    }
+
+    bool usesAvx2() const noexcept
+    {
+        return _useAvx2;
+    }
+
+    // Restricts this evaluator to the scalar kernels, for comparison.
+    void disableAvx2() noexcept
+    {
+        _useAvx2 = false;
+    }
+
+    void evaluate(const CurveBatch &curves, float t, float *outX, float *outY) const noexcept
+    {
+        float weights[MAX_BATCH_DEGREE + 1];
+        basisAt(t, weights);
+
+        std::size_t begin = 0;
+#ifdef CURVE_BATCH_AVX2
+        if (_useAvx2)
+        {
+            begin = sharedAvx2(curves, weights, outX, outY);
+        }
+#endif
+        sharedScalar(curves, weights, begin, curves.count, outX, outY);
+    }
+
+    void evaluate(const CurveBatch &curves, const float *t, float *outX, float *outY) const noexcept
+    {
+        std::size_t begin = 0;
+#ifdef CURVE_BATCH_AVX2
+        if (_useAvx2)
+        {
+            begin = perCurveAvx2(curves, t, outX, outY);
+        }
+#endif
+        perCurveScalar(curves, t, begin, outX, outY);
+    }
+
+private:
+    std::size_t _degree;
+    // _basis[k][j]: coefficient of t^j in the weight of control point k.
+    float _basis[MAX_BATCH_DEGREE + 1][MAX_BATCH_DEGREE + 1] = {};
+    bool _useAvx2 = false;
+
+    // C(n, k) * t^k * (1 - t)^(n - k), expanded.
+    static double bernsteinCoefficient(std::size_t n, std::size_t k, std::size_t j)
+    {
+        if (j < k)
+        {
+            return 0.0;
+        }
+        double sign = (j - k) % 2 == 0 ? 1.0 : -1.0;
+        return sign * static_cast<double>(BINOMIALS(n, k)) * static_cast<double>(BINOMIALS(n - k, j - k));
+    }
+
+    // Control point k of a uniform segment is weighted by the cardinal B-spline
+    // M(x) = 1 / n! * sum_i (-1)^i * C(n + 1, i) * (x - i)^n_+ at x = t + n - k, and only the
+    // terms with i <= n - k are live for t in [0, 1].
+    static double bSplineCoefficient(std::size_t n, std::size_t k, std::size_t j)
+    {
+        double factorial = 1.0;
+        for (std::size_t i = 2; i <= n; ++i)
+        {
+            factorial *= i;
+        }
+
+        double sum = 0.0;
+        for (std::size_t i = 0; i <= n - k; ++i)
+        {
+            double sign = i % 2 == 0 ? 1.0 : -1.0;
+            double shift = static_cast<double>(n - k - i);
+            sum += sign * static_cast<double>(BINOMIALS(n + 1, i)) * static_cast<double>(BINOMIALS(n, j)) * std::pow(shift, static_cast<double>(n - j));
+        }
+        return sum / factorial;
+    }
+
+    void basisAt(float t, float *weights) const noexcept
+    {
+        for (std::size_t k = 0; k <= _degree; ++k)
+        {
+            float weight = 0.0f;
+            for (std::size_t j = _degree + 1; j-- > 0;)
+            {
+                weight = weight * t + _basis[k][j];
+            }
+            weights[k] = weight;
+        }
+    }
+
+    void perCurveScalar(const CurveBatch &curves, const float *t, std::size_t begin, float *outX, float *outY) const noexcept
+    {
+        float weights[MAX_BATCH_DEGREE + 1];
+        for (std::size_t c = begin; c < curves.count; ++c)
+        {
+            basisAt(t[c], weights);
+            sharedScalar(curves, weights, c, c + 1, outX, outY);
+        }
+    }
+
+    void sharedScalar(const CurveBatch &curves, const float *weights, std::size_t begin, std::size_t end, float *outX, float *outY) const noexcept
+    {
+        for (std::size_t c = begin; c < end; ++c)
+        {
+            float x = 0.0f, y = 0.0f, w = 0.0f;
+            for (std::size_t k = 0; k <= _degree; ++k)
+            {
+                float weight = curves.weights ? weights[k] * curves.weights[k * curves.count + c] : weights[k];
+                x += weight * curves.x[k * curves.count + c];
+                y += weight * curves.y[k * curves.count + c];
+                w += weight;
+            }
+            outX[c] = curves.weights ? x / w : x;
+            outY[c] = curves.weights ? y / w : y;
+        }
+    }
+
+#ifdef CURVE_BATCH_AVX2
+    // Both AVX2 kernels handle whole groups of eight curves and return where the scalar tail
+    // should pick up.
+    __attribute__((target("avx2,fma")))
+    std::size_t sharedAvx2(const CurveBatch &curves, const float *weights, float *outX, float *outY) const noexcept
+    {
+        std::size_t count = curves.count;
+        std::size_t end = count - count % 8;
+        for (std::size_t c = 0; c < end; c += 8)
+        {
+            __m256 x = _mm256_setzero_ps(), y = _mm256_setzero_ps(), w = _mm256_setzero_ps();
+            for (std::size_t k = 0; k <= _degree; ++k)
+            {
+                __m256 weight = _mm256_set1_ps(weights[k]);
+                if (curves.weights)
+                {
+                    weight = _mm256_mul_ps(weight, _mm256_loadu_ps(curves.weights + k * count + c));
+                }
+                x = _mm256_fmadd_ps(weight, _mm256_loadu_ps(curves.x + k * count + c), x);
+                y = _mm256_fmadd_ps(weight, _mm256_loadu_ps(curves.y + k * count + c), y);
+                w = _mm256_add_ps(w, weight);
+            }
+            if (curves.weights)
+            {
+                x = _mm256_div_ps(x, w);
+                y = _mm256_div_ps(y, w);
+            }
+            _mm256_storeu_ps(outX + c, x);
+            _mm256_storeu_ps(outY + c, y);
+        }
+        return end;
+    }
+
+    __attribute__((target("avx2,fma")))
+    std::size_t perCurveAvx2(const CurveBatch &curves, const float *t, float *outX, float *outY) const noexcept
+    {
+        std::size_t count = curves.count;
+        std::size_t end = count - count % 8;
+        for (std::size_t c = 0; c < end; c += 8)
+        {
+            __m256 parameter = _mm256_loadu_ps(t + c);
+            __m256 x = _mm256_setzero_ps(), y = _mm256_setzero_ps(), w = _mm256_setzero_ps();
+            for (std::size_t k = 0; k <= _degree; ++k)
+            {
+                __m256 weight = _mm256_set1_ps(_basis[k][_degree]);
+                for (std::size_t j = _degree; j-- > 0;)
+                {
+                    weight = _mm256_fmadd_ps(weight, parameter, _mm256_set1_ps(_basis[k][j]));
+                }
+                if (curves.weights)
+                {
+                    weight = _mm256_mul_ps(weight, _mm256_loadu_ps(curves.weights + k * count + c));
+                }
+                x = _mm256_fmadd_ps(weight, _mm256_loadu_ps(curves.x + k * count + c), x);
+                y = _mm256_fmadd_ps(weight, _mm256_loadu_ps(curves.y + k * count + c), y);
+                w = _mm256_add_ps(w, weight);
+            }
+            if (curves.weights)
+            {
+                x = _mm256_div_ps(x, w);
+                y = _mm256_div_ps(y, w);
+            }
+            _mm256_storeu_ps(outX + c, x);
+            _mm256_storeu_ps(outY + c, y);
+        }
+        return end;
+    }
+#endif
+};
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "bezier.hpp"
+
+struct CurveHit
+{
+    std::size_t curve = 0;
+    float t = 0.0f;
+    point position;
+    float distance = std::numeric_limits<float>::max();
+};
+
+// Closest-point queries against a set of curves. Each curve is cut into SPANS_PER_CURVE
+// spans by de Casteljau, and every span keeps its own control points and the bounding box
+// of their hull, which contains the span. A query first takes the nearest span end point
+// as the best distance so far, then skips every curve and span whose box is already
+// farther than that, and refines the survivors, nearest box first, with a few Newton steps
+// on the exact span.
+class CurvePicker
+{
+public:
+    static constexpr int SPANS_PER_CURVE = 8;
+    static constexpr int NEWTON_STEPS = 4;
+
+    void clear() noexcept
+    {
+        _curves.clear();
+        _spans.clear();
+        _points.clear();
+    }
+
+    std::size_t size() const noexcept
+    {
+        return _curves.size();
+    }
+
+    // scale multiplies each axis of the control points, so queries can be made in pixels.
+    // Returns the index hits report for this curve.
+    template<std::size_t Degree>
+    std::size_t add(const BezierCurve<Degree> &curve, const point &scale = {1.0f, 1.0f})
+    {
+        std::size_t n = curve.degree();
+        point whole[MAX_BEZIER_DEGREE + 1], left[MAX_BEZIER_DEGREE + 1], right[MAX_BEZIER_DEGREE + 1];
+        for (std::size_t i = 0; i <= n; ++i)
+        {
+            whole[i] = {curve.controlPoints()[i].first * scale.first, curve.controlPoints()[i].second * scale.second};
+        }
+
+        Curve entry;
+        entry.firstSpan = static_cast<std::uint32_t>(_spans.size());
+        entry.degree = static_cast<std::uint32_t>(n);
+        entry.box = emptyBox();
+
+        // Peel span i off the front of what is left, splitting at the matching local t.
+        for (int i = 0; i < SPANS_PER_CURVE; ++i)
+        {
+            float split = 1.0f / (SPANS_PER_CURVE - i);
+            subdivide(whole, n, split, left, right);
+
+            Span span;
+            span.t0 = static_cast<float>(i) / SPANS_PER_CURVE;
+            span.t1 = static_cast<float>(i + 1) / SPANS_PER_CURVE;
+            span.firstPoint = static_cast<std::uint32_t>(_points.size());
+            span.box = emptyBox();
+            for (std::size_t k = 0; k <= n; ++k)
+            {
+                _points.push_back(left[k]);
+                span.box.grow(left[k]);
+            }
+            entry.box.grow(span.box);
+            _spans.push_back(span);
+
+            std::copy(right, right + n + 1, whole);
+        }
+
+        _curves.push_back(entry);
+        return _curves.size() - 1;
+    }
+
+    CurveHit closest(const point &query) const noexcept
+    {
+        CurveHit best;
+        float bestSquared = std::numeric_limits<float>::max();
+        for (std::size_t c = 0; c < _curves.size(); ++c)
+        {
+            if (_curves[c].box.distanceSquared(query) < bestSquared)
+            {
+                closestOn(c, query, best, bestSquared);
+            }
+        }
+        best.distance = std::sqrt(bestSquared);
+        return best;
+    }
+
+    CurveHit closest(std::size_t curve, const point &query) const noexcept
+    {
+        CurveHit best;
+        float bestSquared = std::numeric_limits<float>::max();
+        closestOn(curve, query, best, bestSquared);
+        best.distance = std::sqrt(bestSquared);
+        return best;
+    }
+
+private:
+    struct Box
+    {
+        float minX, minY, maxX, maxY;
+
+        void grow(const point &p) noexcept
+        {
+            minX = std::min(minX, p.first);
+            minY = std::min(minY, p.second);
+            maxX = std::max(maxX, p.first);
+            maxY = std::max(maxY, p.second);
+        }
+
+        void grow(const Box &box) noexcept
+        {
+            grow(point(box.minX, box.minY));
+            grow(point(box.maxX, box.maxY));
+        }
+
+        float distanceSquared(const point &p) const noexcept
+        {
+            float dx = std::max({minX - p.first, 0.0f, p.first - maxX});
+            float dy = std::max({minY - p.second, 0.0f, p.second - maxY});
+            return dx * dx + dy * dy;
+        }
+    };
+
+    struct Span
+    {
+        float t0, t1;
+        std::uint32_t firstPoint;
+        Box box;
+    };
+
+    struct Curve
+    {
+        std::uint32_t firstSpan;
+        std::uint32_t degree;
+        Box box;
+    };
+
+    std::vector<Curve> _curves;
+    std::vector<Span> _spans;
+    std::vector<point> _points;
+
+    static Box emptyBox() noexcept
+    {
+        float inf = std::numeric_limits<float>::max();
+        return {inf, inf, -inf, -inf};
+    }
+
+    static float distanceSquared(const point &a, const point &b) noexcept
+    {
+        float dx = a.first - b.first, dy = a.second - b.second;
+        return dx * dx + dy * dy;
+    }
+
+    static void subdivide(const point *points, std::size_t n, float t, point *left, point *right) noexcept
+    {
+        point level[MAX_BEZIER_DEGREE + 1];
+        std::copy(points, points + n + 1, level);
+        for (std::size_t k = 0; k <= n; ++k)
+        {
+            left[k] = level[0];
+            right[n - k] = level[n - k];
+            for (std::size_t i = 0; i + k < n; ++i)
+            {
+                level[i] = {level[i].first + (level[i + 1].first - level[i].first) * t,
+                            level[i].second + (level[i + 1].second - level[i].second) * t};
+            }
+        }
+    }
+
+    // Position, first and second derivative of a span at local u, by de Casteljau.
+    static void evaluateSpan(const point *points, std::size_t n, float u, point &position, point &first, point &second) noexcept
+    {
+        float x[MAX_BEZIER_DEGREE + 1], y[MAX_BEZIER_DEGREE + 1];
+        for (std::size_t i = 0; i <= n; ++i)
+        {
+            x[i] = points[i].first;
+            y[i] = points[i].second;
+        }
+
+        second = {0.0f, 0.0f};
+        for (std::size_t size = n; size >= 1; --size)
+        {
+            if (size == 2)
+            {
+                float scale = static_cast<float>(n * (n - 1));
+                second = {scale * (x[0] - 2.0f * x[1] + x[2]), scale * (y[0] - 2.0f * y[1] + y[2])};
+            }
+            if (size == 1)
+            {
+                first = {n * (x[1] - x[0]), n * (y[1] - y[0])};
+            }
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                x[i] += (x[i + 1] - x[i]) * u;
+                y[i] += (y[i + 1] - y[i]) * u;
+            }
+        }
+        position = {x[0], y[0]};
+    }
+
+    void closestOn(std::size_t c, const point &query, CurveHit &best, float &bestSquared) const noexcept
+    {
+        const Curve &curve = _curves[c];
+        std::size_t n = curve.degree;
+        const Span *spans = _spans.data() + curve.firstSpan;
+
+        // Every span starts on the curve, and the last one ends on it too.
+        for (int s = 0; s <= SPANS_PER_CURVE; ++s)
+        {
+            const point &end = s < SPANS_PER_CURVE ? _points[spans[s].firstPoint] : _points[spans[s - 1].firstPoint + n];
+            float squared = distanceSquared(end, query);
+            if (squared < bestSquared)
+            {
+                bestSquared = squared;
+                best.curve = c;
+                best.t = static_cast<float>(s) / SPANS_PER_CURVE;
+                best.position = end;
+            }
+        }
+
+        if (n == 0)
+        {
+            return;
+        }
+
+        // Refine the nearest boxes first, so the first good hit prunes the rest.
+        float boxSquared[SPANS_PER_CURVE];
+        int order[SPANS_PER_CURVE];
+        for (int s = 0; s < SPANS_PER_CURVE; ++s)
+        {
+            boxSquared[s] = spans[s].box.distanceSquared(query);
+            int i = s;
+            for (; i > 0 && boxSquared[order[i - 1]] > boxSquared[s]; --i)
+            {
+                order[i] = order[i - 1];
+            }
+            order[i] = s;
+        }
+
+        for (int s: order)
+        {
+            const Span &span = spans[s];
+            if (boxSquared[s] >= bestSquared)
+            {
+                break;
+            }
+
+            // Start from the projection onto the chord, then Newton on (S(u) - q) . S'(u) = 0.
+            const point *points = _points.data() + span.firstPoint;
+            float chordX = points[n].first - points[0].first, chordY = points[n].second - points[0].second;
+            float chordSquared = chordX * chordX + chordY * chordY;
+            float u = chordSquared > 0.0f ? ((query.first - points[0].first) * chordX + (query.second - points[0].second) * chordY) / chordSquared : 0.5f;
+            u = std::min(std::max(u, 0.0f), 1.0f);
+
+            point position, first, second;
+            for (int step = 0; step < NEWTON_STEPS; ++step)
+            {
+                evaluateSpan(points, n, u, position, first, second);
+                float offsetX = position.first - query.first, offsetY = position.second - query.second;
+                float slope = offsetX * first.first + offsetY * first.second;
+                float curvature = first.first * first.first + first.second * first.second + offsetX * second.first + offsetY * second.second;
+                if (curvature <= 0.0f)
+                {
+                    break;
+                }
+                u = std::min(std::max(u - slope / curvature, 0.0f), 1.0f);
+            }
+            evaluateSpan(points, n, u, position, first, second);
+
+            float squared = distanceSquared(position, query);
+            if (squared < bestSquared)
+            {
+                bestSquared = squared;
+                best.curve = c;
+                best.t = span.t0 + (span.t1 - span.t0) * u;
+                best.position = position;
+            }
+        }
+    }
+};
@@ -1,145 +1,214 @@
-#include <SFML/Graphics.hpp>
-#include <SFML/OpenGL.hpp>
-#include <cmath>
-#include <array>
-
-#define CONTROL_POINTS 4
-#define CURVE_POINTS 1000
-
-using point = std::pair<float, float>;
-
-template<typename std::size_t Size>
-using point_array = std::array<point, Size>;
-
-point evaluateBezier(float t, const point_array<CONTROL_POINTS> &controlPoints) noexcept
-{
-    auto x = 0.0f, y = 0.0f;
-    auto n = controlPoints.size() - 1;
-    for (int i = 0; i <= n; ++i)
-    {
-        float blend = std::pow(1 - t, n - i) * std::pow(t, i) *
-                      (std::tgamma(n + 1) / (std::tgamma(i + 1) * std::tgamma(n - i + 1)));
-        x += controlPoints[i].first * blend;
-        y += controlPoints[i].second * blend;
-    }
-    return std::make_pair(x, y);
-}
-
-point_array<CURVE_POINTS> computeBezierCurvePoints(const point_array<CONTROL_POINTS> &controlPoints) noexcept
-{
-    point_array<CURVE_POINTS> result;
-
-    float t = 0.0f;
-    for (auto &elem: result)
-    {
-        elem = evaluateBezier(t, controlPoints);
-        t += 0.001f;
-    }
-
-    return result;
-}
-
-void drawBezierCurve(const point_array<CURVE_POINTS> &bezierCurvePoints) noexcept
-{
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glBegin(GL_LINE_STRIP);
-    for (const auto &point: bezierCurvePoints)
-    {
-        glVertex2f(point.first, point.second);
-    }
-    glEnd();
-}
-
-void render(std::size_t index, const point_array<CURVE_POINTS> &bezierCurvePoints) noexcept
-{
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    drawBezierCurve(bezierCurvePoints);
-
-    glColor3f(1.0f, 0.0f, 0.0f);
-    auto circlePoint = bezierCurvePoints[index];
-    glBegin(GL_TRIANGLE_FAN);
-    glVertex2f(circlePoint.first, circlePoint.second);
-    for (int i = 0; i <= 360; ++i)
-    {
-        float angle = i * M_PI / 180.0f;
-        float size = 0.05f + (static_cast<float>(index) / 20000);
-        glVertex2f(circlePoint.first + size * std::cos(angle), circlePoint.second + size * std::sin(angle));
-    }
-    glEnd();
-}
-
-int main()
-{
-    sf::ContextSettings settings;
-    settings.depthBits = 24;
-    settings.stencilBits = 8;
-    settings.antialiasingLevel = 4;
-    settings.majorVersion = 3;
-    settings.minorVersion = 3;
-
-    constexpr point_array<CONTROL_POINTS> controlPoints = {
-        std::make_pair(-0.8f, -0.5f),
-        std::make_pair(-0.2f, 0.8f),
-        std::make_pair(0.2f, -0.8f),
-        std::make_pair(0.8f, 0.5f)
-    };
-
-    sf::RenderWindow window(sf::VideoMode(800, 600), "FIRST LAB", sf::Style::Default, settings);
-
-    sf::RectangleShape plusButton(sf::Vector2f(50.f, 50.f));
-    plusButton.setPosition(650, 50);
-    plusButton.setFillColor(sf::Color::Green);
-
-    sf::RectangleShape minusButton(sf::Vector2f(50.f, 50.f));
-    minusButton.setPosition(650, 150);
-    minusButton.setFillColor(sf::Color::Red);
-
-    auto plusBounds = plusButton.getGlobalBounds();
-    auto minusBounds = minusButton.getGlobalBounds();
-
-    auto bezierCurvePoints = computeBezierCurvePoints(controlPoints);
-    std::size_t index = 0;
-    std::size_t sign = 1;
-    std::size_t coefficient = 10;
-
-    while (window.isOpen())
-    {
-        sf::Event event;
-        while (window.pollEvent(event))
-        {
-            if (event.type == sf::Event::Closed)
-            {
-                window.close();
-            }
-
-            if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left)
-            {
-                auto mousePos = sf::Mouse::getPosition(window);
-                if (plusBounds.contains(mousePos.x, mousePos.y) && coefficient < 7)
-                {
-                    coefficient++;
-                }
-                else if (minusBounds.contains(mousePos.x, mousePos.y) && coefficient > 0)
-                {
-                    coefficient--;
-                }
-            }
-        }
-
-        window.clear();
-        render(index, bezierCurvePoints);
-
-        window.pushGLStates();
-        window.draw(plusButton);
-        window.draw(minusButton);
-        window.popGLStates();
-
-        window.display();
-
-        index += coefficient * sign;
-        if (index > CURVE_POINTS - 1 || index < 1) sign *= -1;
-    }
-
-    return 0;
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <array>
+#include <string>
+#include <vector>
+
+#include "bezier.hpp"
+#include "curve_picking.hpp"
+#include "frame_recorder.hpp"
+#include "profiler_overlay.hpp"
+
+#define CONTROL_POINTS 4
+#define CURVE_POINTS 1000
+#define CURVE_TOLERANCE 0.25f
+// Marker speed on screen in pixels per second for each step of the +/- buttons.
+#define MARKER_SPEED 45.0f
+#define MARKER_SEGMENTS 360
+// Clicks within this many pixels of the curve move the marker there.
+#define PICK_DISTANCE 10.0f
+
+using curve = BezierCurve<CONTROL_POINTS - 1>;
+
+// Pixels per curve unit along each axis: the curve spans [-1, 1] of the window.
+point pixelScale(const sf::Window &window) noexcept
+{
+    return std::make_pair(window.getSize().x * 0.5f, window.getSize().y * 0.5f);
+}
+
+// Uploads the polyline into the curve's vertex buffer, reallocating only when the vertex
+// count changes.
+void uploadBezierCurve(const std::vector<point> &bezierCurvePoints, sf::VertexBuffer &curveBuffer)
+{
+    std::vector<sf::Vertex> vertices;
+    vertices.reserve(bezierCurvePoints.size());
+    for (const auto &point: bezierCurvePoints)
+    {
+        vertices.emplace_back(sf::Vector2f(point.first, point.second), sf::Color::White);
+    }
+
+    if (curveBuffer.getVertexCount() != vertices.size())
+    {
+        curveBuffer.create(vertices.size());
+    }
+    curveBuffer.update(vertices.data());
+}
+
+// Unit circle as a triangle fan around the origin, placed and sized by a transform per frame.
+sf::VertexBuffer createMarkerMesh()
+{
+    std::vector<sf::Vertex> vertices;
+    vertices.emplace_back(sf::Vector2f(0.0f, 0.0f), sf::Color::Red);
+    for (int i = 0; i <= MARKER_SEGMENTS; ++i)
+    {
+        float angle = i * 2.0f * static_cast<float>(M_PI) / MARKER_SEGMENTS;
+        vertices.emplace_back(sf::Vector2f(std::cos(angle), std::sin(angle)), sf::Color::Red);
+    }
+
+    sf::VertexBuffer markerMesh(sf::TriangleFan, sf::VertexBuffer::Static);
+    markerMesh.create(vertices.size());
+    markerMesh.update(vertices.data());
+    return markerMesh;
+}
+
+// progress is the marker's share of the curve length travelled, from 0 to 1.
+void render(sf::RenderWindow &window, const sf::VertexBuffer &curveBuffer, const sf::VertexBuffer &markerMesh, const point &markerPosition, float progress)
+{
+    // Curve units: [-1, 1] across the window with y pointing up.
+    window.setView(sf::View(sf::FloatRect(-1.0f, 1.0f, 2.0f, -2.0f)));
+
+    window.draw(curveBuffer);
+
+    float size = 0.05f + 0.05f * progress;
+    sf::Transform markerTransform;
+    markerTransform.translate(markerPosition.first, markerPosition.second).scale(size, size);
+    window.draw(markerMesh, markerTransform);
+
+    window.setView(window.getDefaultView());
+}
+
+int main()
+{
+    sf::ContextSettings settings;
+    settings.depthBits = 24;
+    settings.stencilBits = 8;
+    settings.antialiasingLevel = 4;
+    settings.majorVersion = 3;
+    settings.minorVersion = 3;
+
+    constexpr point_array<CONTROL_POINTS> controlPoints = {
+        std::make_pair(-0.8f, -0.5f),
+        std::make_pair(-0.2f, 0.8f),
+        std::make_pair(0.2f, -0.8f),
+        std::make_pair(0.8f, 0.5f)
+    };
+
+    sf::RenderWindow window(sf::VideoMode(800, 600), "FIRST LAB", sf::Style::Default, settings);
+
+    sf::RectangleShape plusButton(sf::Vector2f(50.f, 50.f));
+    plusButton.setPosition(650, 50);
+    plusButton.setFillColor(sf::Color::Green);
+
+    sf::RectangleShape minusButton(sf::Vector2f(50.f, 50.f));
+    minusButton.setPosition(650, 150);
+    minusButton.setFillColor(sf::Color::Red);
+
+    auto plusBounds = plusButton.getGlobalBounds();
+    auto minusBounds = minusButton.getGlobalBounds();
+
+    // The polyline, its vertex buffer and the arc-length table depend on the curve and the
+    // window size, and are rebuilt only when either changes.
+    curve bezierCurve(controlPoints);
+    std::vector<point> bezierCurvePoints;
+    sf::VertexBuffer curveBuffer(sf::LineStrip, sf::VertexBuffer::Static);
+    sf::VertexBuffer markerMesh = createMarkerMesh();
+    ArcLengthTable arcLength(bezierCurve, pixelScale(window));
+    CurvePicker picker;
+    float distance = 0.0f;
+    auto rebuildCurve = [&]
+    {
+        PROFILE_ZONE("rebuild curve");
+        float progress = distance / arcLength.length();
+        arcLength = ArcLengthTable(bezierCurve, pixelScale(window));
+        distance = progress * arcLength.length();
+        picker.clear();
+        picker.add(bezierCurve, pixelScale(window));
+
+        bezierCurve.flatten(CURVE_TOLERANCE, pixelScale(window), bezierCurvePoints);
+        uploadBezierCurve(bezierCurvePoints, curveBuffer);
+        window.setTitle("FIRST LAB | " + std::to_string(bezierCurvePoints.size()) + " vertices at " +
+                        std::to_string(CURVE_TOLERANCE).substr(0, 4) + " px (fixed: " + std::to_string(CURVE_POINTS) + ")");
+    };
+    rebuildCurve();
+
+    float direction = 1.0f;
+    std::size_t coefficient = 10;
+    sf::Clock frameClock;
+    ProfilerOverlay overlay("lab1_trace.json");
+    FrameRecorder recorder("lab1_capture");
+
+    while (window.isOpen())
+    {
+        PROFILE_ZONE("frame");
+        sf::Event event;
+        while (window.pollEvent(event))
+        {
+            overlay.handleEvent(event);
+            recorder.handleEvent(event);
+            if (event.type == sf::Event::Closed)
+            {
+                window.close();
+            }
+
+            if (event.type == sf::Event::Resized)
+            {
+                rebuildCurve();
+            }
+
+            if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left)
+            {
+                auto mousePos = sf::Mouse::getPosition(window);
+                if (plusBounds.contains(mousePos.x, mousePos.y) && coefficient < 7)
+                {
+                    coefficient++;
+                }
+                else if (minusBounds.contains(mousePos.x, mousePos.y) && coefficient > 0)
+                {
+                    coefficient--;
+                }
+                else
+                {
+                    PROFILE_ZONE("pick");
+                    // The picker works in pixels with y up and the origin at the window centre.
+                    point scale = pixelScale(window);
+                    CurveHit hit = picker.closest({mousePos.x - scale.first, scale.second - mousePos.y});
+                    if (hit.distance <= PICK_DISTANCE)
+                    {
+                        distance = arcLength.distanceAt(hit.t);
+                    }
+                }
+            }
+        }
+
+        window.clear();
+        {
+            PROFILE_ZONE("render");
+            render(window, curveBuffer, markerMesh, bezierCurve.evaluate(arcLength.uniformParameterAt(distance)), distance / arcLength.length());
+
+            window.draw(plusButton);
+            window.draw(minusButton);
+        }
+        recorder.capture(window);
+        overlay.draw(window);
+
+        {
+            PROFILE_ZONE("display");
+            window.display();
+        }
+        overlay.update();
+
+        distance += direction * coefficient * MARKER_SPEED * frameClock.restart().asSeconds();
+        if (distance > arcLength.length())
+        {
+            distance = 2.0f * arcLength.length() - distance;
+            direction = -1.0f;
+        }
+        else if (distance < 0.0f)
+        {
+            distance = -distance;
+            direction = 1.0f;
+        }
+    }
+
+    return 0;
 }
\ No newline at end of file
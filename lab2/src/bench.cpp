@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "allocation_hooks.hpp"
+#include "bench_timing.hpp"
+#include "cube.hpp"
+
+namespace
+{
+    constexpr int SCREEN_WIDTH = 800;
+    constexpr int SCREEN_HEIGHT = 600;
+    // Largest channel difference LightSet::shade may have from the legacy shading. Channels
+    // are in [0, 1]; the sums run over the lights in a different order and with normals
+    // rotated rather than rebuilt, so they drift by a few float steps.
+    constexpr float SHADE_TOLERANCE = 1e-6f;
+
+    // Cube::draw's shading before LightSet, generalized from its two light arguments to a
+    // list: normals rebuilt from rotated vertices with a sqrt each, then one scalar dot
+    // product per face and light.
+    namespace legacy
+    {
+        struct Light
+        {
+            sf::Vector3f direction;
+            sf::Vector3f color;
+        };
+
+        std::vector<sf::Vector3f> rotateVertices(const std::vector<sf::Vector3f> &vertices, float angleX, float angleY)
+        {
+            std::vector<sf::Vector3f> rotatedVertices;
+            float cosX = std::cos(angleX);
+            float sinX = std::sin(angleX);
+            float cosY = std::cos(angleY);
+            float sinY = std::sin(angleY);
+
+            for (const auto &vertex: vertices)
+            {
+                float y1 = vertex.y * cosX - vertex.z * sinX;
+                float z1 = vertex.y * sinX + vertex.z * cosX;
+                rotatedVertices.push_back({vertex.x * cosY + z1 * sinY, y1, -vertex.x * sinY + z1 * cosY});
+            }
+
+            return rotatedVertices;
+        }
+
+        sf::Vector3f calculateNormal(const sf::Vector3f &v1, const sf::Vector3f &v2, const sf::Vector3f &v3)
+        {
+            sf::Vector3f edge1 = v2 - v1;
+            sf::Vector3f edge2 = v3 - v1;
+            sf::Vector3f normal =
+            {
+                edge1.y * edge2.z - edge1.z * edge2.y,
+                edge1.z * edge2.x - edge1.x * edge2.z,
+                edge1.x * edge2.y - edge1.y * edge2.x
+            };
+            float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+            return normal / length;
+        }
+
+        float dotProduct(const sf::Vector3f &v1, const sf::Vector3f &v2)
+        {
+            return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+        }
+
+        void shadeCube(const std::vector<sf::Vector3f> &vertices, const std::vector<std::vector<int>> &faces, float angleX, float angleY,
+                       const std::vector<Light> &lights, std::vector<sf::Vector3f> &colors)
+        {
+            std::vector<sf::Vector3f> rotatedVertices = rotateVertices(vertices, angleX, angleY);
+            for (const auto &face: faces)
+            {
+                sf::Vector3f normal = calculateNormal(rotatedVertices[face[0]], rotatedVertices[face[1]], rotatedVertices[face[2]]);
+                sf::Vector3f total;
+                for (const auto &light: lights)
+                {
+                    total += std::max(LIGHT_FLOOR, dotProduct(normal, light.direction)) * light.color;
+                }
+                colors.push_back({std::min(1.0f, total.x), std::min(1.0f, total.y), std::min(1.0f, total.z)});
+            }
+        }
+
+        // Cube::draw's geometry before FrameArena: fresh vectors for the rotated and projected
+        // vertices, and an sf::VertexArray per visible face. Returns the vertex count.
+        std::size_t buildQuads(const std::vector<sf::Vector3f> &vertices, const std::vector<std::vector<int>> &faces, float angleX, float angleY,
+                               const FaceNormals &normals, std::size_t firstFace, const sf::Vector3f &position)
+        {
+            std::vector<sf::Vector3f> rotatedVertices = rotateVertices(vertices, angleX, angleY);
+            std::vector<sf::Vector2f> projectedVertices;
+            mat4 toScreen = mat4::projection(256.0f, SCREEN_WIDTH, SCREEN_HEIGHT) * mat4::translation(position);
+            for (const auto &vertex: rotatedVertices)
+            {
+                vec3 projected = toScreen.projectPoint(vertex);
+                projectedVertices.push_back({projected.x, projected.y});
+            }
+
+            std::size_t count = 0;
+            for (std::size_t f = 0; f < faces.size(); ++f)
+            {
+                if (normals.z[firstFace + f] < 0)
+                {
+                    continue;
+                }
+                sf::VertexArray quad(sf::Quads, 4);
+                for (int i = 0; i < 4; ++i)
+                {
+                    quad[i].position = projectedVertices[faces[f][i]];
+                }
+                count += quad.getVertexCount();
+            }
+            return count;
+        }
+    }
+
+    // Returns false when the shading differs from the legacy code by more than SHADE_TOLERANCE.
+    bool benchmarkShading(std::size_t cubeCount, std::size_t lightCount)
+    {
+        std::mt19937 random(40);
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+        std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> channel(0.0f, 2.0f / lightCount);
+
+        LightSet lights;
+        std::vector<legacy::Light> legacyLights;
+        for (std::size_t l = 0; l < lightCount; ++l)
+        {
+            sf::Vector3f direction = {coordinate(random), coordinate(random), coordinate(random)};
+            direction /= std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+            sf::Vector3f color = {channel(random), channel(random), channel(random)};
+            lights.add(direction, color);
+            legacyLights.push_back({direction, color});
+        }
+
+        std::vector<float> anglesX(cubeCount), anglesY(cubeCount);
+        for (std::size_t c = 0; c < cubeCount; ++c)
+        {
+            anglesX[c] = angle(random);
+            anglesY[c] = angle(random);
+        }
+
+        Cube cube(100.0f, {0.0f, 0.0f, 5.0f}, SCREEN_WIDTH, SCREEN_HEIGHT);
+        const float s = 100.0f;
+        std::vector<sf::Vector3f> vertices = {{-s, -s, -s}, {s, -s, -s}, {s, s, -s}, {-s, s, -s}, {-s, -s, s}, {s, -s, s}, {s, s, s}, {-s, s, s}};
+        std::vector<std::vector<int>> faces = {{0, 1, 2, 3}, {1, 5, 6, 2}, {5, 4, 7, 6}, {4, 0, 3, 7}, {0, 1, 5, 4}, {3, 2, 6, 7}};
+
+        std::vector<sf::Vector3f> legacyColors;
+        double legacyTime = measureNanoseconds([&]
+        {
+            legacyColors.clear();
+            for (std::size_t c = 0; c < cubeCount; ++c)
+            {
+                legacy::shadeCube(vertices, faces, anglesX[c], anglesY[c], legacyLights, legacyColors);
+            }
+        }, 5);
+
+        FaceNormals normals;
+        FaceColors colors;
+        double rotateTime = measureNanoseconds([&]
+        {
+            normals.clear();
+            for (std::size_t c = 0; c < cubeCount; ++c)
+            {
+                cube.rotateNormals(anglesX[c], anglesY[c], normals);
+            }
+        }, 5);
+        double shadeTime = measureNanoseconds([&]
+        {
+            lights.shade(normals, colors);
+        }, 5);
+
+        float error = 0.0f;
+        for (std::size_t f = 0; f < normals.size(); ++f)
+        {
+            error = std::max({error, std::abs(colors.red[f] - legacyColors[f].x), std::abs(colors.green[f] - legacyColors[f].y),
+                              std::abs(colors.blue[f] - legacyColors[f].z)});
+        }
+
+        std::size_t faceCount = cubeCount * cube.faceCount();
+        double lightFaces = static_cast<double>(faceCount) * lightCount;
+        std::printf("%zu cubes (%zu faces) x %zu lights:\n", cubeCount, faceCount, lightCount);
+        std::printf("    per-face normals + scalar dot products %8.2f ms (%5.2f ns per face-light)\n", legacyTime / 1e6, legacyTime / lightFaces);
+        std::printf("    rotated normals + LightSet::shade      %8.2f ms (%5.2f ns per face-light), %.2f ms of it rotating normals\n",
+                    (rotateTime + shadeTime) / 1e6, (rotateTime + shadeTime) / lightFaces, rotateTime / 1e6);
+        std::printf("    speedup %.1fx, largest channel difference %.1e%s\n", legacyTime / (rotateTime + shadeTime), error,
+                    error <= SHADE_TOLERANCE ? "" : ", ABOVE TOLERANCE");
+        return error <= SHADE_TOLERANCE;
+    }
+
+    // Heap allocations and time for one frame of cubeCount cubes' geometry, built the old
+    // way and through a FrameArena reset every frame.
+    void benchmarkFrameAllocations(std::size_t cubeCount)
+    {
+        std::mt19937 random(47);
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+        std::vector<float> anglesX(cubeCount), anglesY(cubeCount);
+        for (std::size_t c = 0; c < cubeCount; ++c)
+        {
+            anglesX[c] = angle(random);
+            anglesY[c] = angle(random);
+        }
+
+        LightSet lights;
+        lights.add({0.0f, -1.0f, 0.0f});
+        lights.add({-1.0f, 1.0f, 1.0f});
+        Cube cube(100.0f, {0.0f, 0.0f, 5.0f}, SCREEN_WIDTH, SCREEN_HEIGHT);
+        const float s = 100.0f;
+        std::vector<sf::Vector3f> vertices = {{-s, -s, -s}, {s, -s, -s}, {s, s, -s}, {-s, s, -s}, {-s, -s, s}, {s, -s, s}, {s, s, s}, {-s, s, s}};
+        std::vector<std::vector<int>> faces = {{0, 1, 2, 3}, {1, 5, 6, 2}, {5, 4, 7, 6}, {4, 0, 3, 7}, {0, 1, 5, 4}, {3, 2, 6, 7}};
+
+        // Visibility comes from the same rotated normals on both paths.
+        FaceNormals normals;
+        for (std::size_t c = 0; c < cubeCount; ++c)
+        {
+            cube.rotateNormals(anglesX[c], anglesY[c], normals);
+        }
+
+        std::size_t legacyVertices = 0;
+        HeapCounts legacyHeap;
+        double legacyTime = measureNanoseconds([&]
+        {
+            HeapCounts start = HeapCounts::now();
+            legacyVertices = 0;
+            for (std::size_t c = 0; c < cubeCount; ++c)
+            {
+                legacyVertices += legacy::buildQuads(vertices, faces, anglesX[c], anglesY[c], normals, c * faces.size(), {0.0f, 0.0f, 5.0f});
+            }
+            legacyHeap = HeapCounts::now() - start;
+        }, 5);
+
+        FrameArena arena;
+        std::size_t arenaVertices = 0;
+        HeapCounts arenaHeap;
+        double arenaTime = measureNanoseconds([&]
+        {
+            HeapCounts start = HeapCounts::now();
+            arena.reset();
+            FrameVector<sf::Vertex> quads(arena);
+            quads.reserve(cubeCount * cube.faceCount() * 4);
+            for (std::size_t c = 0; c < cubeCount; ++c)
+            {
+                cube.buildQuads(anglesX[c], anglesY[c], lights, arena, quads);
+            }
+            arenaVertices = quads.size();
+            arenaHeap = HeapCounts::now() - start;
+        }, 5);
+
+        std::printf("%zu cubes, geometry for one frame:\n", cubeCount);
+        std::printf("    vectors + VertexArray per face %8.2f ms, %7llu heap allocations, %9llu bytes, %zu vertices\n", legacyTime / 1e6,
+                    static_cast<unsigned long long>(legacyHeap.allocations), static_cast<unsigned long long>(legacyHeap.bytes), legacyVertices);
+        std::printf("    FrameArena, shading included   %8.2f ms, %7llu heap allocations, %9llu bytes, %zu vertices, arena %zu bytes in %zu blocks allocated\n",
+                    arenaTime / 1e6, static_cast<unsigned long long>(arenaHeap.allocations), static_cast<unsigned long long>(arenaHeap.bytes), arenaVertices,
+                    arena.peakBytes(), arena.blockAllocations());
+    }
+}
+
+int main()
+{
+#if defined(__AVX__)
+    std::printf("shading kernel: AVX, 8 faces per iteration\n");
+#elif defined(__SSE2__) || defined(_M_X64)
+    std::printf("shading kernel: SSE, 4 faces per iteration\n");
+#else
+    std::printf("shading kernel: scalar\n");
+#endif
+
+    bool passed = benchmarkShading(10000, 2);
+    passed &= benchmarkShading(10000, 64);
+    benchmarkFrameAllocations(10000);
+
+    return passed ? 0 : 1;
+}
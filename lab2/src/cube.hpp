@@ -0,0 +1,156 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cmath>
+
+#include "frame_arena.hpp"
+#include "lighting.hpp"
+#include "profiler.hpp"
+#include "vector_math.hpp"
+
+class Cube 
+{
+public:
+    Cube(float size, sf::Vector3f position, int screenWidth, int screenHeight): 
+        _size(size), _position(position), _screenWidth(screenWidth), _screenHeight(screenHeight) 
+    {
+        _vertices = 
+        {
+            {-_size, -_size, -_size},
+            { _size, -_size, -_size},
+            { _size,  _size, -_size},
+            {-_size,  _size, -_size},
+            {-_size, -_size,  _size},
+            { _size, -_size,  _size},
+            { _size,  _size,  _size},
+            {-_size,  _size,  _size}
+        };
+
+        faces = 
+        {
+            {0, 1, 2, 3},
+            {1, 5, 6, 2},
+            {5, 4, 7, 6},
+            {4, 0, 3, 7},
+            {0, 1, 5, 4},
+            {3, 2, 6, 7}
+        };
+
+        // Rotation keeps normals unit length, so they are normalized once here.
+        for (const auto &face: faces)
+        {
+            _normals.push_back(cross(_vertices[face[1]] - _vertices[face[0]], _vertices[face[2]] - _vertices[face[0]]).normalize());
+        }
+    }
+
+    std::size_t faceCount() const noexcept
+    {
+        return faces.size();
+    }
+
+    // Appends the rotated face normals to normals, in face order.
+    void rotateNormals(float angleX, float angleY, FaceNormals &normals) const
+    {
+        mat3 rotation = rotationOf(angleX, angleY);
+        for (const auto &normal: _normals)
+        {
+            normals.push((rotation * normal).as<sf::Vector3f>());
+        }
+    }
+
+    // Appends the visible faces to quads as four coloured vertices each. Every buffer
+    // the frame needs comes from arena; reserve quads up front, since the arena keeps
+    // each buffer a growing vector leaves behind.
+    void buildQuads(float angleX, float angleY, const LightSet &lights, FrameArena &arena, FrameVector<sf::Vertex> &quads)
+    {
+        FrameVector<sf::Vector2f> projectedVertices(arena);
+        {
+            PROFILE_ZONE("transform");
+            FrameVector<sf::Vector3f> rotatedVertices(arena);
+            rotateVertices(angleX, angleY, rotatedVertices);
+            projectVertices(rotatedVertices, projectedVertices);
+
+            _rotatedNormals.clear();
+            rotateNormals(angleX, angleY, _rotatedNormals);
+        }
+        {
+            PROFILE_ZONE("shade");
+            lights.shade(_rotatedNormals, _colors);
+        }
+
+        PROFILE_ZONE("build quads");
+        sf::Vector3f cameraDirection = {0.0f, 0.0f, -1.0f};
+
+        for (std::size_t f = 0; f < faces.size(); ++f)
+        {
+            const auto &face = faces[f];
+            sf::Vector3f normal = {_rotatedNormals.x[f], _rotatedNormals.y[f], _rotatedNormals.z[f]};
+
+            if (dot(normal, cameraDirection) > 0) 
+            {
+                continue;
+            }
+
+            sf::Color color(255 * _colors.red[f], 255 * _colors.green[f], 255 * _colors.blue[f]);
+            for (int i = 0; i < 4; ++i) 
+            {
+                quads.push_back(sf::Vertex(projectedVertices[face[i]], color));
+            }
+        }
+    }
+
+    // Draws the visible faces in one call; arena must be reset by the caller each frame.
+    void draw(sf::RenderWindow &window, float angleX, float angleY, const LightSet &lights, FrameArena &arena) 
+    {
+        FrameVector<sf::Vertex> quads(arena);
+        quads.reserve(faceCount() * 4);
+        buildQuads(angleX, angleY, lights, arena, quads);
+
+        PROFILE_ZONE("draw faces");
+        if (!quads.empty())
+        {
+            window.draw(quads.data(), quads.size(), sf::Quads);
+        }
+    }
+
+private:
+    float _size;
+    sf::Vector3f _position;
+    int _screenWidth, _screenHeight;
+    std::vector<sf::Vector3f> _vertices;
+    std::vector<std::vector<int>> faces;
+    std::vector<vec3> _normals;
+    FaceNormals _rotatedNormals;
+    FaceColors _colors;
+
+    // Rotation about x, then about y.
+    static mat3 rotationOf(float angleX, float angleY) noexcept
+    {
+        return mat3::rotationY(angleY) * mat3::rotationX(angleX);
+    }
+
+    void rotateVertices(float angleX, float angleY, FrameVector<sf::Vector3f> &rotatedVertices) 
+    {
+        mat3 rotation = rotationOf(angleX, angleY);
+        rotatedVertices.reserve(_vertices.size());
+
+        for (const auto &vertex: _vertices) 
+        {
+            rotatedVertices.push_back((rotation * vertex).as<sf::Vector3f>());
+        }
+    }
+
+    // The cube sits at _position in front of a camera at the origin.
+    void projectVertices(const FrameVector<sf::Vector3f> &vertices, FrameVector<sf::Vector2f> &projectedVertices) 
+    {
+        mat4 toScreen = mat4::projection(256.0f, _screenWidth, _screenHeight) * mat4::translation(_position);
+        projectedVertices.reserve(vertices.size());
+
+        for (const auto &vertex: vertices) 
+        {
+            vec3 projected = toScreen.projectPoint(vertex);
+            projectedVertices.push_back({projected.x, projected.y});
+        }
+    }
+};
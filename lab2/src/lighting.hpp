@@ -0,0 +1,156 @@
+#pragma once
+
+#include <SFML/System/Vector3.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+// Every light lights every face at least this much, as lab2 always has.
+constexpr float LIGHT_FLOOR = 0.2f;
+
+// Face normals, or any unit vectors, in structure-of-arrays layout.
+struct FaceNormals
+{
+    std::vector<float> x, y, z;
+
+    std::size_t size() const noexcept
+    {
+        return x.size();
+    }
+
+    void clear() noexcept
+    {
+        x.clear();
+        y.clear();
+        z.clear();
+    }
+
+    void push(const sf::Vector3f &normal)
+    {
+        x.push_back(normal.x);
+        y.push_back(normal.y);
+        z.push_back(normal.z);
+    }
+};
+
+// Shaded face colours with channels in [0, 1].
+struct FaceColors
+{
+    std::vector<float> red, green, blue;
+
+    void resize(std::size_t count)
+    {
+        red.resize(count);
+        green.resize(count);
+        blue.resize(count);
+    }
+};
+
+// Directional lights in structure-of-arrays layout. A face's colour is
+// min(1, sum over lights of max(LIGHT_FLOOR, normal . direction) * color); directions are
+// used as given, so a longer direction is a brighter light.
+class LightSet
+{
+public:
+    std::size_t size() const noexcept
+    {
+        return _directionX.size();
+    }
+
+    void clear() noexcept
+    {
+        _directionX.clear();
+        _directionY.clear();
+        _directionZ.clear();
+        _red.clear();
+        _green.clear();
+        _blue.clear();
+    }
+
+    void add(const sf::Vector3f &direction, const sf::Vector3f &color = {1.0f, 1.0f, 1.0f})
+    {
+        _directionX.push_back(direction.x);
+        _directionY.push_back(direction.y);
+        _directionZ.push_back(direction.z);
+        _red.push_back(color.x);
+        _green.push_back(color.y);
+        _blue.push_back(color.z);
+    }
+
+    // Shades every face against every light in one pass: a group of faces stays in
+    // registers while all lights are applied to it, and is stored once.
+    void shade(const FaceNormals &normals, FaceColors &colors) const
+    {
+        std::size_t count = normals.size();
+        colors.resize(count);
+        const float *nx = normals.x.data(), *ny = normals.y.data(), *nz = normals.z.data();
+        float *outRed = colors.red.data(), *outGreen = colors.green.data(), *outBlue = colors.blue.data();
+        std::size_t lightCount = size();
+        std::size_t i = 0;
+
+#if defined(__AVX__)
+        const __m256 floor = _mm256_set1_ps(LIGHT_FLOOR), one = _mm256_set1_ps(1.0f);
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 x = _mm256_loadu_ps(nx + i), y = _mm256_loadu_ps(ny + i), z = _mm256_loadu_ps(nz + i);
+            __m256 red = _mm256_setzero_ps(), green = _mm256_setzero_ps(), blue = _mm256_setzero_ps();
+            for (std::size_t l = 0; l < lightCount; ++l)
+            {
+                __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(_directionX[l])), _mm256_mul_ps(y, _mm256_set1_ps(_directionY[l]))),
+                                         _mm256_mul_ps(z, _mm256_set1_ps(_directionZ[l])));
+                d = _mm256_max_ps(d, floor);
+                red = _mm256_add_ps(red, _mm256_mul_ps(d, _mm256_set1_ps(_red[l])));
+                green = _mm256_add_ps(green, _mm256_mul_ps(d, _mm256_set1_ps(_green[l])));
+                blue = _mm256_add_ps(blue, _mm256_mul_ps(d, _mm256_set1_ps(_blue[l])));
+            }
+            _mm256_storeu_ps(outRed + i, _mm256_min_ps(red, one));
+            _mm256_storeu_ps(outGreen + i, _mm256_min_ps(green, one));
+            _mm256_storeu_ps(outBlue + i, _mm256_min_ps(blue, one));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128 floor = _mm_set1_ps(LIGHT_FLOOR), one = _mm_set1_ps(1.0f);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(nx + i), y = _mm_loadu_ps(ny + i), z = _mm_loadu_ps(nz + i);
+            __m128 red = _mm_setzero_ps(), green = _mm_setzero_ps(), blue = _mm_setzero_ps();
+            for (std::size_t l = 0; l < lightCount; ++l)
+            {
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(_directionX[l])), _mm_mul_ps(y, _mm_set1_ps(_directionY[l]))),
+                                      _mm_mul_ps(z, _mm_set1_ps(_directionZ[l])));
+                d = _mm_max_ps(d, floor);
+                red = _mm_add_ps(red, _mm_mul_ps(d, _mm_set1_ps(_red[l])));
+                green = _mm_add_ps(green, _mm_mul_ps(d, _mm_set1_ps(_green[l])));
+                blue = _mm_add_ps(blue, _mm_mul_ps(d, _mm_set1_ps(_blue[l])));
+            }
+            _mm_storeu_ps(outRed + i, _mm_min_ps(red, one));
+            _mm_storeu_ps(outGreen + i, _mm_min_ps(green, one));
+            _mm_storeu_ps(outBlue + i, _mm_min_ps(blue, one));
+        }
+#endif
+
+        for (; i < count; ++i)
+        {
+            float red = 0.0f, green = 0.0f, blue = 0.0f;
+            for (std::size_t l = 0; l < lightCount; ++l)
+            {
+                float d = std::max(nx[i] * _directionX[l] + ny[i] * _directionY[l] + nz[i] * _directionZ[l], LIGHT_FLOOR);
+                red += d * _red[l];
+                green += d * _green[l];
+                blue += d * _blue[l];
+            }
+            outRed[i] = std::min(red, 1.0f);
+            outGreen[i] = std::min(green, 1.0f);
+            outBlue[i] = std::min(blue, 1.0f);
+        }
+    }
+
+private:
+    std::vector<float> _directionX, _directionY, _directionZ;
+    std::vector<float> _red, _green, _blue;
+};
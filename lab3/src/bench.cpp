@@ -0,0 +1,113 @@
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "cube.hpp"
+#include "cube_field.hpp"
+
+namespace
+{
+    constexpr int SCREEN_WIDTH = 800;
+    constexpr int SCREEN_HEIGHT = 600;
+    constexpr float FIELD_LENGTH = 40000.0f;
+    constexpr float GRID_CELL_SIZE = 250.0f;
+    constexpr int PATH_FRAMES = 200;
+
+    double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Flies lab3's middle camera path through a field of cubeCount cubes and builds each
+    // frame's triangles as main does, without a window. The visible set of every frame is
+    // checked against testing every cube. Returns false if a set differs or a vertex is not
+    // finite.
+    bool benchmarkFlyThrough(std::size_t cubeCount)
+    {
+        std::vector<CubeInstance> cubes = generateCubeField(cubeCount, {{-2000.0f, -1000.0f, 100.0f}, {2000.0f, 1000.0f, FIELD_LENGTH}}, 10.0f, 30.0f, 3);
+
+        auto buildStart = std::chrono::steady_clock::now();
+        CubeGrid grid;
+        grid.build(cubes, GRID_CELL_SIZE);
+        double buildTime = millisecondsSince(buildStart);
+
+        CubeMesh cube;
+        sf::VertexArray triangles(sf::Triangles);
+        std::vector<std::uint32_t> visible, everyCube;
+        sf::Vector3f cameraEnd = {300.0f, 0.0f, FIELD_LENGTH};
+
+        std::size_t minVisible = cubeCount, maxVisible = 0, totalVisible = 0, totalCells = 0, totalClipped = 0, mismatches = 0;
+        double totalQuery = 0.0, totalFrame = 0.0, maxFrame = 0.0, totalBrute = 0.0;
+        bool finite = true;
+
+        for (int frame = 0; frame < PATH_FRAMES; ++frame)
+        {
+            sf::Vector3f cameraPos = cameraEnd * (static_cast<float>(frame) / (PATH_FRAMES - 1));
+            ViewFrustum frustum(cameraPos, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+            auto frameStart = std::chrono::steady_clock::now();
+            FieldStats stats;
+            visible.clear();
+            stats.cellsVisited = grid.query(cubes, frustum, visible);
+            stats.cubesVisible = visible.size();
+            totalQuery += millisecondsSince(frameStart);
+            std::sort(visible.begin(), visible.end(), [&](std::uint32_t a, std::uint32_t b)
+            {
+                return cubes[a].position.z > cubes[b].position.z;
+            });
+            triangles.clear();
+            for (auto index: visible)
+            {
+                cube.append(cubes[index], 0.0f, 0.0f, frustum, triangles, stats);
+            }
+            double frameTime = millisecondsSince(frameStart);
+
+            auto bruteStart = std::chrono::steady_clock::now();
+            everyCube.clear();
+            for (std::uint32_t i = 0; i < cubes.size(); ++i)
+            {
+                if (frustum.intersectsSphere(cubes[i].position, cubes[i].size * CUBE_RADIUS_SCALE))
+                {
+                    everyCube.push_back(i);
+                }
+            }
+            totalBrute += millisecondsSince(bruteStart);
+
+            std::sort(visible.begin(), visible.end());
+            mismatches += visible != everyCube;
+
+            for (std::size_t v = 0; v < triangles.getVertexCount(); ++v)
+            {
+                finite &= std::isfinite(triangles[v].position.x) && std::isfinite(triangles[v].position.y);
+            }
+
+            minVisible = std::min(minVisible, stats.cubesVisible);
+            maxVisible = std::max(maxVisible, stats.cubesVisible);
+            totalVisible += stats.cubesVisible;
+            totalCells += stats.cellsVisited;
+            totalClipped += stats.facesClipped;
+            totalFrame += frameTime;
+            maxFrame = std::max(maxFrame, frameTime);
+        }
+
+        std::printf("%zu cubes, %zu grid cells of %.0f built in %.1f ms, %d frames along the path:\n", cubeCount, grid.cellCount(), GRID_CELL_SIZE, buildTime, PATH_FRAMES);
+        std::printf("    visible cubes min %zu, mean %zu, max %zu; cells visited mean %zu\n", minVisible, totalVisible / PATH_FRAMES, maxVisible, totalCells / PATH_FRAMES);
+        std::printf("    culling: grid query %.3f ms, testing every cube %.3f ms (%.1fx) per frame\n",
+                    totalQuery / PATH_FRAMES, totalBrute / PATH_FRAMES, totalBrute / totalQuery);
+        std::printf("    frame (query, sort far to near, clip and build triangles): mean %.2f ms, max %.2f ms\n", totalFrame / PATH_FRAMES, maxFrame);
+        std::printf("    faces clipped at the near plane %zu, %s, visible sets %s\n", totalClipped,
+                    finite ? "all vertices finite" : "NON-FINITE VERTICES", mismatches ? "DIFFER from testing every cube" : "match testing every cube");
+        return finite && mismatches == 0;
+    }
+}
+
+int main()
+{
+    bool passed = benchmarkFlyThrough(100000);
+    passed &= benchmarkFlyThrough(400000);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cmath>
+
+#include "cube_field.hpp"
+#include "vector_math.hpp"
+#include "view.hpp"
+
+struct FieldStats
+{
+    std::size_t cellsVisited = 0;
+    std::size_t cubesVisible = 0;
+    std::size_t facesDrawn = 0;
+    std::size_t facesClipped = 0;
+    std::size_t triangles = 0;
+};
+
+// Builds the triangles of cube instances: one unit cube, scaled, rotated and placed per
+// instance, with faces turned away from the camera dropped and faces crossing the near
+// plane clipped to it before projection.
+class CubeMesh
+{
+public:
+    CubeMesh()
+    {
+        _vertices =
+        {{
+            {-1.0f, -1.0f, -1.0f},
+            { 1.0f, -1.0f, -1.0f},
+            { 1.0f,  1.0f, -1.0f},
+            {-1.0f,  1.0f, -1.0f},
+            {-1.0f, -1.0f,  1.0f},
+            { 1.0f, -1.0f,  1.0f},
+            { 1.0f,  1.0f,  1.0f},
+            {-1.0f,  1.0f,  1.0f}
+        }};
+
+        _faces =
+        {{
+            {{0, 1, 2, 3}},
+            {{1, 5, 6, 2}},
+            {{5, 4, 7, 6}},
+            {{4, 0, 3, 7}},
+            {{0, 1, 5, 4}},
+            {{3, 2, 6, 7}}
+        }};
+    }
+
+    // Appends the visible faces of cube as triangles in shades of grey that tell its sides apart.
+    void append(const CubeInstance &cube, float angleX, float angleY, const ViewFrustum &frustum, sf::VertexArray &triangles, FieldStats &stats) const
+    {
+        static const sf::Uint8 FACE_SHADES[6] = {230, 180, 130, 200, 150, 100};
+
+        std::array<sf::Vector3f, 8> relative = rotateVertices(cube, angleX, angleY, frustum.cameraPosition());
+        sf::Vector3f center = cube.position - frustum.cameraPosition();
+        // The eye sits FOV behind the camera position.
+        sf::Vector3f eye = {0.0f, 0.0f, -FOV};
+
+        for (std::size_t f = 0; f < _faces.size(); ++f)
+        {
+            const auto &face = _faces[f];
+            sf::Vector3f polygon[4];
+            sf::Vector3f faceCenter;
+            bool crossesNear = false;
+            for (int i = 0; i < 4; ++i)
+            {
+                polygon[i] = relative[face[i]];
+                faceCenter += polygon[i];
+                crossesNear |= polygon[i].z + FOV < NEAR_DEPTH;
+            }
+            faceCenter = faceCenter * 0.25f;
+
+            if (dot(faceCenter - center, faceCenter - eye) >= 0.0f)
+            {
+                continue;
+            }
+
+            sf::Vector3f clipped[MAX_CLIPPED_VERTICES];
+            std::size_t count = frustum.clipNear(polygon, 4, clipped);
+            if (count < 3)
+            {
+                continue;
+            }
+            stats.facesClipped += crossesNear;
+            ++stats.facesDrawn;
+
+            sf::Color color(FACE_SHADES[f], FACE_SHADES[f], FACE_SHADES[f]);
+            sf::Vector2f first = frustum.project(clipped[0]);
+            sf::Vector2f previous = frustum.project(clipped[1]);
+            for (std::size_t i = 2; i < count; ++i)
+            {
+                sf::Vector2f current = frustum.project(clipped[i]);
+                triangles.append(sf::Vertex(first, color));
+                triangles.append(sf::Vertex(previous, color));
+                triangles.append(sf::Vertex(current, color));
+                previous = current;
+                ++stats.triangles;
+            }
+        }
+    }
+
+private:
+    std::array<sf::Vector3f, 8> _vertices;
+    std::array<std::array<int, 4>, 6> _faces;
+
+    // Vertices of cube relative to the camera.
+    std::array<sf::Vector3f, 8> rotateVertices(const CubeInstance &cube, float angleX, float angleY, const sf::Vector3f &cameraPosition) const
+    {
+        std::array<sf::Vector3f, 8> rotatedVertices;
+        // Rotation about x, then about y, of the cube scaled to its size.
+        mat3 rotation = mat3::rotationY(angleY) * mat3::rotationX(angleX);
+        vec3 offset = cube.position - cameraPosition;
+
+        for (std::size_t i = 0; i < _vertices.size(); ++i)
+        {
+            rotatedVertices[i] = (rotation * (vec3(_vertices[i]) * cube.size) + offset).as<sf::Vector3f>();
+        }
+
+        return rotatedVertices;
+    }
+};
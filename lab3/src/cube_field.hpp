@@ -0,0 +1,154 @@
+#pragma once
+
+#include <SFML/System/Vector3.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "view.hpp"
+
+// A cube of any rotation with half-size size fits in a sphere of size * sqrt(3).
+constexpr float CUBE_RADIUS_SCALE = 1.7320508f;
+
+struct CubeInstance
+{
+    sf::Vector3f position;
+    float size;
+};
+
+struct FieldBounds
+{
+    sf::Vector3f min;
+    sf::Vector3f max;
+};
+
+inline std::vector<CubeInstance> generateCubeField(std::size_t count, const FieldBounds &bounds, float minSize, float maxSize, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> x(bounds.min.x, bounds.max.x);
+    std::uniform_real_distribution<float> y(bounds.min.y, bounds.max.y);
+    std::uniform_real_distribution<float> z(bounds.min.z, bounds.max.z);
+    std::uniform_real_distribution<float> size(minSize, maxSize);
+
+    std::vector<CubeInstance> cubes(count);
+    for (auto &cube: cubes)
+    {
+        cube.position = {x(random), y(random), z(random)};
+        cube.size = size(random);
+    }
+    return cubes;
+}
+
+// Uniform grid over cube centres with the cubes of each cell stored contiguously: the
+// cubes of cell c are indices[offsets[c]] to indices[offsets[c + 1]].
+class CubeGrid
+{
+public:
+    void build(const std::vector<CubeInstance> &cubes, float cellSize)
+    {
+        _cellSize = cellSize;
+        _maxRadius = 0.0f;
+        sf::Vector3f min = cubes.empty() ? sf::Vector3f() : cubes[0].position, max = min;
+        for (const auto &cube: cubes)
+        {
+            min = {std::min(min.x, cube.position.x), std::min(min.y, cube.position.y), std::min(min.z, cube.position.z)};
+            max = {std::max(max.x, cube.position.x), std::max(max.y, cube.position.y), std::max(max.z, cube.position.z)};
+            _maxRadius = std::max(_maxRadius, cube.size * CUBE_RADIUS_SCALE);
+        }
+        _origin = min;
+        _columns = static_cast<int>((max.x - min.x) / cellSize) + 1;
+        _rows = static_cast<int>((max.y - min.y) / cellSize) + 1;
+        _layers = static_cast<int>((max.z - min.z) / cellSize) + 1;
+
+        // Count, prefix sum, then fill.
+        _offsets.assign(cellCount() + 1, 0);
+        std::vector<std::uint32_t> cells(cubes.size());
+        for (std::size_t i = 0; i < cubes.size(); ++i)
+        {
+            cells[i] = static_cast<std::uint32_t>(cellOf(cubes[i].position));
+            ++_offsets[cells[i] + 1];
+        }
+        for (std::size_t c = 0; c < cellCount(); ++c)
+        {
+            _offsets[c + 1] += _offsets[c];
+        }
+        _indices.resize(cubes.size());
+        std::vector<std::uint32_t> next(_offsets.begin(), _offsets.end() - 1);
+        for (std::size_t i = 0; i < cubes.size(); ++i)
+        {
+            _indices[next[cells[i]]++] = static_cast<std::uint32_t>(i);
+        }
+    }
+
+    std::size_t cellCount() const noexcept
+    {
+        return static_cast<std::size_t>(_columns) * _rows * _layers;
+    }
+
+    // Appends the cubes whose bounding spheres touch the frustum and returns how many
+    // cells were visited. Each layer of cells visits only the columns and rows that the
+    // frustum reaches at the layer's far side.
+    std::size_t query(const std::vector<CubeInstance> &cubes, const ViewFrustum &frustum, std::vector<std::uint32_t> &visible) const
+    {
+        const sf::Vector3f &camera = frustum.cameraPosition();
+        std::size_t visited = 0;
+        for (int layer = 0; layer < _layers; ++layer)
+        {
+            float nearSide = frustum.depthOf({0.0f, 0.0f, _origin.z + layer * _cellSize}) - _maxRadius;
+            float farSide = nearSide + _cellSize + 2.0f * _maxRadius;
+            if (farSide < NEAR_DEPTH || nearSide > FAR_DEPTH)
+            {
+                continue;
+            }
+
+            float depth = std::min(farSide, FAR_DEPTH + _maxRadius);
+            float reachX = frustum.reachX(depth, _maxRadius);
+            float reachY = frustum.reachY(depth, _maxRadius);
+            int firstColumn = clampCell((camera.x - reachX - _origin.x) / _cellSize, _columns);
+            int lastColumn = clampCell((camera.x + reachX - _origin.x) / _cellSize, _columns);
+            int firstRow = clampCell((camera.y - reachY - _origin.y) / _cellSize, _rows);
+            int lastRow = clampCell((camera.y + reachY - _origin.y) / _cellSize, _rows);
+
+            for (int row = firstRow; row <= lastRow; ++row)
+            {
+                for (int column = firstColumn; column <= lastColumn; ++column)
+                {
+                    std::size_t cell = (static_cast<std::size_t>(layer) * _rows + row) * _columns + column;
+                    ++visited;
+                    for (std::uint32_t i = _offsets[cell]; i < _offsets[cell + 1]; ++i)
+                    {
+                        const CubeInstance &cube = cubes[_indices[i]];
+                        if (frustum.intersectsSphere(cube.position, cube.size * CUBE_RADIUS_SCALE))
+                        {
+                            visible.push_back(_indices[i]);
+                        }
+                    }
+                }
+            }
+        }
+        return visited;
+    }
+
+private:
+    sf::Vector3f _origin;
+    float _cellSize = 1.0f;
+    float _maxRadius = 0.0f;
+    int _columns = 0, _rows = 0, _layers = 0;
+    std::vector<std::uint32_t> _offsets;
+    std::vector<std::uint32_t> _indices;
+
+    static int clampCell(float cell, int cells) noexcept
+    {
+        return std::min(std::max(static_cast<int>(std::floor(cell)), 0), cells - 1);
+    }
+
+    std::size_t cellOf(const sf::Vector3f &position) const noexcept
+    {
+        int column = clampCell((position.x - _origin.x) / _cellSize, _columns);
+        int row = clampCell((position.y - _origin.y) / _cellSize, _rows);
+        int layer = clampCell((position.z - _origin.z) / _cellSize, _layers);
+        return (static_cast<std::size_t>(layer) * _rows + row) * _columns + column;
+    }
+};
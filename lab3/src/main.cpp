@@ -1,119 +1,30 @@
 #include <array>
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <string>
 #include <vector>
-#include <cmath>
 
-class Cube 
-{
-public:
-    Cube(float size, sf::Vector3f position, int screenWidth, int screenHeight): 
-        _size(size), _position(position), _screenWidth(screenWidth), _screenHeight(screenHeight) 
-    {
-        _vertices = 
-        {
-            {-_size, -_size, -_size},
-            { _size, -_size, -_size},
-            { _size,  _size, -_size},
-            {-_size,  _size, -_size},
-            {-_size, -_size,  _size},
-            { _size, -_size,  _size},
-            { _size,  _size,  _size},
-            {-_size,  _size,  _size}
-        };
-
-        _faces = 
-        {
-            {0, 1, 2, 3},
-            {1, 5, 6, 2},
-            {5, 4, 7, 6},
-            {4, 0, 3, 7},
-            {0, 1, 5, 4},
-            {3, 2, 6, 7}
-        };
-    }
-
-    void draw(sf::RenderWindow &window, float angleX, float angleY, sf::Vector3f cameraPosition) 
-    {
-        std::vector<sf::Vector3f> rotatedVertices = rotateVertices(angleX, angleY);
-        std::vector<sf::Vector2f> projectedVertices = projectVertices(rotatedVertices, cameraPosition);
-
-        for (const auto &face: _faces) 
-        {
-            sf::VertexArray quad(sf::Quads, 4);
-            for (int i = 0; i < 4; ++i) 
-            {
-                quad[i].position = projectedVertices[face[i]];
-            }
-
-            window.draw(quad);
-        }
-    }
-
-private:
-    float _size;
-    sf::Vector3f _position;
-    int _screenWidth, _screenHeight;
-    std::vector<sf::Vector3f> _vertices;
-    std::vector<std::vector<int>> _faces;
-
-    std::vector<sf::Vector3f> rotateVertices(float angleX, float angleY) 
-    {
-        std::vector<sf::Vector3f> rotatedVertices;
-        float cosX = std::cos(angleX);
-        float sinX = std::sin(angleX);
-        float cosY = std::cos(angleY);
-        float sinY = std::sin(angleY);
-
-        for (const auto &vertex: _vertices) 
-        {
-            float x = vertex.x;
-            float y = vertex.y;
-            float z = vertex.z;
-
-            float y1 = y * cosX - z * sinX;
-            float z1 = y * sinX + z * cosX;
-
-            float x1 = x * cosY + z1 * sinY;
-            float z2 = -x * sinY + z1 * cosY;
-
-            rotatedVertices.push_back({x1, y1, z2});
-        }
-
-        return rotatedVertices;
-    }
-
-    std::vector<sf::Vector2f> projectVertices(const std::vector<sf::Vector3f> &vertices, sf::Vector3f cameraPosition) 
-    {
-        std::vector<sf::Vector2f> projectedVertices;
-        float fov = 256.0f;
-        float aspectRatio = static_cast<float>(_screenWidth) / _screenHeight;
+#include "allocation_hooks.hpp"
+#include "cube.hpp"
+#include "cube_field.hpp"
+#include "frame_recorder.hpp"
+#include "profiler_overlay.hpp"
 
-        for (const auto &vertex: vertices) 
-        {
-            float x = vertex.x + _position.x - cameraPosition.x;
-            float y = vertex.y + _position.y - cameraPosition.y;
-            float z = vertex.z + _position.z - cameraPosition.z;
-
-            float zInv = 1.0f / (z + fov);
-            float xProj = x * zInv * fov * aspectRatio + _screenWidth / 2;
-            float yProj = y * zInv * fov + _screenHeight / 2;
-
-            projectedVertices.push_back({xProj, yProj});
-        }
-
-        return projectedVertices;
-    }
-};
+constexpr std::size_t FIELD_CUBES = 100000;
+constexpr float FIELD_LENGTH = 40000.0f;
+constexpr float GRID_CELL_SIZE = 250.0f;
 
 int main() {
     sf::RenderWindow window(sf::VideoMode(800, 600), "THIRD_LAB");
 
-    std::vector<Cube> cubes = 
-    {
-        Cube(20.0f, {0.0f, 0.0f, 150.0f}, window.getSize().x, window.getSize().y),
-        Cube(20.0f, {60.0f, 0.0f, 100.0f}, window.getSize().x, window.getSize().y),
-        Cube(20.0f, {-40.0f, 0.0f, 80.0f}, window.getSize().x, window.getSize().y)
-    };
+    std::vector<CubeInstance> cubes = generateCubeField(FIELD_CUBES, {{-2000.0f, -1000.0f, 100.0f}, {2000.0f, 1000.0f, FIELD_LENGTH}}, 10.0f, 30.0f, 3);
+    CubeGrid grid;
+    grid.build(cubes, GRID_CELL_SIZE);
+
+    CubeMesh cube;
+    sf::VertexArray triangles(sf::Triangles);
+    std::vector<std::uint32_t> visible;
+    FieldStats stats;
 
     float angleX = 0.0f;
     float angleY = 0.0f;
@@ -121,35 +32,44 @@ int main() {
     sf::Vector3f cameraStart = {0.0f, 0.0f, 0.0f};
     std::array<sf::Vector3f, 3> cameraEnd = 
     {
-        sf::Vector3f{-20.0f, 0.0f, 300.0f},
-        sf::Vector3f{30.0f, 0.0f, 300.0f},
-        sf::Vector3f{80.0f, 0.0f, 300.0f}
+        sf::Vector3f{-200.0f, 0.0f, FIELD_LENGTH},
+        sf::Vector3f{300.0f, 0.0f, FIELD_LENGTH},
+        sf::Vector3f{800.0f, 0.0f, FIELD_LENGTH}
     };
 
-    float cameraSpeed = 0.001f;
+    float cameraSpeed = 0.0001f;
     float cameraPosition = 0.0f;
 
     std::size_t direction = 1;
+    sf::Clock frameClock;
+    sf::Clock statsClock;
+    ProfilerOverlay overlay("lab3_trace.json");
+    FrameRecorder recorder("lab3_capture");
+    FrameHeapMeter heapMeter;
 
     while (window.isOpen()) 
     {
+        heapMeter.beginFrame();
+        PROFILE_ZONE("frame");
         sf::Event event;
         while (window.pollEvent(event)) {
+            overlay.handleEvent(event);
+            recorder.handleEvent(event);
             if (event.type == sf::Event::Closed)
             {
                 window.close();
             }
             if (sf::Keyboard::isKeyPressed(sf::Keyboard::W)) 
             {
-                cameraSpeed += 0.001f;
-                if (cameraSpeed > 0.01f) 
+                cameraSpeed += 0.0001f;
+                if (cameraSpeed > 0.001f) 
                 {
-                    cameraSpeed = 0.01f;
+                    cameraSpeed = 0.001f;
                 }
             }
             if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) 
             {
-                cameraSpeed -= 0.001f;
+                cameraSpeed -= 0.0001f;
                 if (cameraSpeed < 0.0f) 
                 {
                     cameraSpeed = 0.0f;
@@ -169,6 +89,7 @@ int main() {
             }
         }
 
+        frameClock.restart();
         window.clear();
 
         cameraPosition += cameraSpeed;
@@ -187,12 +108,55 @@ int main() {
             cameraStart.z + (cameraEnd[direction].z - cameraStart.z) * cameraPosition
         };
 
-        for (auto &cube: cubes) 
+        // Only cubes in grid cells the frustum reaches are tested, and they are drawn far to near.
+        ViewFrustum frustum(cameraPos, window.getSize().x, window.getSize().y);
+        visible.clear();
+        stats = FieldStats();
+        {
+            PROFILE_ZONE("grid query");
+            stats.cellsVisited = grid.query(cubes, frustum, visible);
+            stats.cubesVisible = visible.size();
+        }
+        {
+            PROFILE_ZONE("depth sort");
+            std::sort(visible.begin(), visible.end(), [&](std::uint32_t a, std::uint32_t b)
+            {
+                return cubes[a].position.z > cubes[b].position.z;
+            });
+        }
+        {
+            PROFILE_ZONE("triangles");
+            triangles.clear();
+            for (auto index: visible) 
+            {
+                cube.append(cubes[index], angleX, angleY, frustum, triangles, stats);
+            }
+        }
+        {
+            PROFILE_ZONE("draw");
+            window.draw(triangles);
+        }
+        recorder.capture(window);
+        overlay.draw(window);
+
         {
-            cube.draw(window, angleX, angleY, cameraPos);
+            PROFILE_ZONE("display");
+            window.display();
         }
+        overlay.update();
+        heapMeter.endFrame();
 
-        window.display();
+        if (statsClock.getElapsedTime().asSeconds() >= 1.0f)
+        {
+            FrameHeapMeter::Summary heap = heapMeter.take();
+            window.setTitle("THIRD_LAB | visible cubes " + std::to_string(stats.cubesVisible) + " of " + std::to_string(cubes.size()) +
+                            ", cells " + std::to_string(stats.cellsVisited) +
+                            ", faces " + std::to_string(stats.facesDrawn) +
+                            ", near-clipped " + std::to_string(stats.facesClipped) +
+                            ", frame " + std::to_string(frameClock.getElapsedTime().asMicroseconds() / 1000.0f).substr(0, 5) + " ms" +
+                            ", heap allocations per frame " + std::to_string(heap.allocations / heap.frames) + " (max " + std::to_string(heap.maxAllocations) + ")");
+            statsClock.restart();
+        }
     }
 
     return 0;
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <SFML/System/Vector3.hpp>
+#include <cmath>
+#include <cstddef>
+
+constexpr float FOV = 256.0f;
+// Depth is z relative to the camera plus FOV, the denominator of lab3's projection. Points
+// are clipped to NEAR_DEPTH before they are divided by it, and nothing past FAR_DEPTH is drawn.
+constexpr float NEAR_DEPTH = 1.0f;
+constexpr float FAR_DEPTH = 3000.0f;
+
+// Clipping a convex polygon against one plane adds at most one vertex.
+constexpr std::size_t MAX_CLIPPED_VERTICES = 8;
+
+// The camera looks along +z from cameraPosition, so the frustum's side planes are
+// |x| <= slopeX * depth and |y| <= slopeY * depth around it.
+class ViewFrustum
+{
+public:
+    ViewFrustum(sf::Vector3f cameraPosition, int screenWidth, int screenHeight):
+        _cameraPosition(cameraPosition), _screenWidth(screenWidth), _screenHeight(screenHeight)
+    {
+        _aspectRatio = static_cast<float>(screenWidth) / screenHeight;
+        _slopeX = screenWidth * 0.5f / (FOV * _aspectRatio);
+        _slopeY = screenHeight * 0.5f / FOV;
+        _radiusScaleX = std::sqrt(1.0f + _slopeX * _slopeX);
+        _radiusScaleY = std::sqrt(1.0f + _slopeY * _slopeY);
+    }
+
+    const sf::Vector3f &cameraPosition() const noexcept
+    {
+        return _cameraPosition;
+    }
+
+    float depthOf(const sf::Vector3f &point) const noexcept
+    {
+        return point.z - _cameraPosition.z + FOV;
+    }
+
+    // Farthest a sphere's centre can be from the view axis, sideways and vertically, and
+    // still touch the frustum at the given depth.
+    float reachX(float depth, float radius) const noexcept
+    {
+        return _slopeX * depth + radius * _radiusScaleX;
+    }
+
+    float reachY(float depth, float radius) const noexcept
+    {
+        return _slopeY * depth + radius * _radiusScaleY;
+    }
+
+    bool intersectsSphere(const sf::Vector3f &center, float radius) const noexcept
+    {
+        float depth = depthOf(center);
+        if (depth < NEAR_DEPTH - radius || depth > FAR_DEPTH + radius)
+        {
+            return false;
+        }
+        return std::abs(center.x - _cameraPosition.x) <= reachX(depth, radius) &&
+               std::abs(center.y - _cameraPosition.y) <= reachY(depth, radius);
+    }
+
+    // Sutherland-Hodgman against depth >= NEAR_DEPTH. Points are relative to the camera;
+    // out needs room for count + 1 points. Returns the clipped vertex count, 0 if nothing is left.
+    std::size_t clipNear(const sf::Vector3f *polygon, std::size_t count, sf::Vector3f *out) const noexcept
+    {
+        std::size_t clipped = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const sf::Vector3f &current = polygon[i];
+            const sf::Vector3f &next = polygon[(i + 1) % count];
+            float currentDistance = current.z + FOV - NEAR_DEPTH;
+            float nextDistance = next.z + FOV - NEAR_DEPTH;
+
+            if (currentDistance >= 0.0f)
+            {
+                out[clipped++] = current;
+            }
+            if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+            {
+                float t = currentDistance / (currentDistance - nextDistance);
+                out[clipped++] = current + (next - current) * t;
+            }
+        }
+        return clipped;
+    }
+
+    // Screen position of a camera-relative point with depth >= NEAR_DEPTH.
+    sf::Vector2f project(const sf::Vector3f &point) const noexcept
+    {
+        float zInv = 1.0f / (point.z + FOV);
+        return {point.x * zInv * FOV * _aspectRatio + _screenWidth / 2, point.y * zInv * FOV + _screenHeight / 2};
+    }
+
+private:
+    sf::Vector3f _cameraPosition;
+    int _screenWidth, _screenHeight;
+    float _aspectRatio;
+    float _slopeX, _slopeY;
+    float _radiusScaleX, _radiusScaleY;
+};
@@ -2,39 +2,61 @@
 
 uniform vec3 fragNormal;
 uniform vec3 fragPosition;
-
-uniform vec3 lightPosition1;
-uniform vec3 lightPosition2;
 uniform vec3 cameraPosition;
-uniform bool enableLight1;
-uniform bool enableLight2;
+
+// Clustered point lights, see LightTextures in src/light_textures.hpp for the layout.
+uniform sampler2D lightTexture;
+uniform sampler2D clusterTexture;
+uniform int textureWidth;
+uniform vec2 screenSize;
+uniform float fov;
+uniform ivec3 clusterGrid;
+uniform float clusterNear;
+uniform float clusterSliceScale;
 
 out vec4 fragColor;
 
+vec4 fetch(sampler2D data, int texel)
+{
+    return texelFetch(data, ivec2(texel % textureWidth, texel / textureWidth), 0);
+}
+
+// Same lookup as LightClusters::clusterAt.
+int clusterAt(vec3 position)
+{
+    vec3 view = position - cameraPosition;
+    float w = max(view.z + fov, 1e-6);
+    float column = (view.x / w * fov * (screenSize.x / screenSize.y) + screenSize.x * 0.5) * float(clusterGrid.x) / screenSize.x;
+    float row = (view.y / w * fov + screenSize.y * 0.5) * float(clusterGrid.y) / screenSize.y;
+    float slice = w < clusterNear ? 0.0 : log(w / clusterNear) * clusterSliceScale;
+    ivec3 cell = ivec3(clamp(floor(vec3(column, row, slice)), vec3(0.0), vec3(clusterGrid - 1)));
+    return (cell.z * clusterGrid.y + cell.y) * clusterGrid.x + cell.x;
+}
+
 void main() 
 {
     vec3 normal = normalize(fragNormal);
-    vec3 viewDirection = normalize(cameraPosition - fragPosition);
 
     vec3 result = vec3(0.0);
 
-    if (enableLight1) 
-    {
-        vec3 lightDirection1 = normalize(lightPosition1 - fragPosition);
-        float diff1 = max(dot(normal, lightDirection1), 0.0);
-        vec3 diffuse1 = vec3(0.8, 0.8, 0.8) * diff1;
-        result += diffuse1;
-    }
-
-    if (enableLight2) 
+    vec4 cluster = fetch(clusterTexture, clusterAt(fragPosition));
+    int first = int(cluster.x);
+    int count = int(cluster.y);
+    for (int i = 0; i < count; ++i)
     {
-        vec3 lightDirection2 = normalize(lightPosition2 - fragPosition);
-        float diff2 = max(dot(normal, lightDirection2), 0.0);
-        vec3 diffuse2 = vec3(0.8, 0.8, 0.8) * diff2;
-        result += diffuse2;
+        int component = first + i;
+        int light = int(fetch(clusterTexture, component / 4)[component % 4]);
+        vec4 positionRange = fetch(lightTexture, 2 * light);
+        vec3 color = fetch(lightTexture, 2 * light + 1).rgb;
+
+        vec3 toLight = positionRange.xyz - fragPosition;
+        float distance = length(toLight);
+        float falloff = clamp(1.0 - distance / positionRange.w, 0.0, 1.0);
+        float diff = max(dot(normal, toLight / distance), 0.0);
+        result += color * diff * falloff * falloff;
     }
 
     vec3 ambient = vec3(0.2, 0.2, 0.2);
 
     fragColor = vec4(result + ambient, 1.0);
-}
\ No newline at end of file
+}
@@ -0,0 +1,599 @@
+#include <SFML/System/Vector2.hpp>
+#include <SFML/System/Vector3.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "allocation_hooks.hpp"
+#include "bench_timing.hpp"
+#include "face_queue.hpp"
+#include "lighting.hpp"
+#include "object_store.hpp"
+#include "scene.hpp"
+#include "systems.hpp"
+#include "transform.hpp"
+
+namespace
+{
+    constexpr int SCREEN_WIDTH = 800;
+    constexpr int SCREEN_HEIGHT = 600;
+
+    int failures = 0;
+
+    // Counts a failure, and names it, when a correctness check does not hold.
+    void expect(const char *check, bool passed)
+    {
+        if (!passed)
+        {
+            std::printf("FAILED %s\n", check);
+            ++failures;
+        }
+    }
+
+    // The per-vertex rotate-then-project path lab4 used before the matrix pipeline.
+    void referenceTransform(const std::vector<sf::Vector3f> &vertices, float angleX, float angleY, const sf::Vector3f &position,
+                            const sf::Vector3f &cameraPosition, std::vector<sf::Vector3f> &rotatedVertices, std::vector<sf::Vector2f> &projectedVertices)
+    {
+        rotatedVertices.clear();
+        projectedVertices.clear();
+
+        float cosX = std::cos(angleX);
+        float sinX = std::sin(angleX);
+        float cosY = std::cos(angleY);
+        float sinY = std::sin(angleY);
+
+        for (const auto &vertex: vertices)
+        {
+            float y1 = vertex.y * cosX - vertex.z * sinX;
+            float z1 = vertex.y * sinX + vertex.z * cosX;
+
+            float x1 = vertex.x * cosY + z1 * sinY;
+            float z2 = -vertex.x * sinY + z1 * cosY;
+
+            rotatedVertices.push_back({x1, y1, z2});
+        }
+
+        float fov = 256.0f;
+        float aspectRatio = static_cast<float>(SCREEN_WIDTH) / SCREEN_HEIGHT;
+
+        for (const auto &vertex: rotatedVertices)
+        {
+            float x = vertex.x + position.x - cameraPosition.x;
+            float y = vertex.y + position.y - cameraPosition.y;
+            float z = vertex.z + position.z - cameraPosition.z;
+
+            float zInv = 1.0f / (z + fov);
+            projectedVertices.push_back({x * zInv * fov * aspectRatio + SCREEN_WIDTH / 2, y * zInv * fov + SCREEN_HEIGHT / 2});
+        }
+    }
+
+    void benchmarkTransform(std::size_t vertexCount)
+    {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+
+        std::vector<sf::Vector3f> vertices(vertexCount);
+        for (auto &vertex: vertices)
+        {
+            vertex = {coordinate(random), coordinate(random), coordinate(random)};
+        }
+
+        const float angleX = 0.3f, angleY = 0.5f;
+        const sf::Vector3f position = {3.0f, 0.0f, 0.0f};
+        const sf::Vector3f cameraPosition = {0.0f, 0.0f, -5.0f};
+        const int repetitions = vertexCount >= 1000000 ? 5 : 20;
+
+        std::vector<sf::Vector3f> rotatedVertices;
+        std::vector<sf::Vector2f> projectedVertices;
+        double scalar = measureNanoseconds([&]
+        {
+            referenceTransform(vertices, angleX, angleY, position, cameraPosition, rotatedVertices, projectedVertices);
+        }, repetitions);
+
+        VertexStream input(vertices);
+        VertexStream worldVertices;
+        VertexStream screenVertices;
+        worldVertices.resize(vertexCount);
+        screenVertices.resize(vertexCount);
+        double batch = measureNanoseconds([&]
+        {
+            Matrix4 model = Matrix4::translation(position) * Matrix4::rotationY(angleY) * Matrix4::rotationX(angleX);
+            Matrix4 view = Matrix4::translation({-cameraPosition.x, -cameraPosition.y, -cameraPosition.z});
+            Matrix4 modelViewProjection = Matrix4::projection(FOV, SCREEN_WIDTH, SCREEN_HEIGHT) * view * model;
+
+            transformPoints(model, input, worldVertices);
+            projectPoints(modelViewProjection, input, screenVertices);
+        }, repetitions);
+
+        float maxError = 0.0f;
+        for (std::size_t i = 0; i < vertexCount; ++i)
+        {
+            maxError = std::max(maxError, std::abs(screenVertices.x[i] - projectedVertices[i].x));
+            maxError = std::max(maxError, std::abs(screenVertices.y[i] - projectedVertices[i].y));
+        }
+
+        std::printf("transform %8zu vertices: scalar %8.2f ns/vertex, batch %8.2f ns/vertex, speedup %5.2fx, max screen error %.2e px\n",
+                    vertexCount, scalar / vertexCount, batch / vertexCount, scalar / batch, maxError);
+    }
+
+    // Field layout of a Sphere before meshes were shared: a private vertex list and one heap
+    // allocated index vector per face.
+    struct LegacySphereLayout
+    {
+        void *vtable;
+        sf::Vector3f position;
+        int screenWidth, screenHeight;
+        std::vector<sf::Vector3f> vertices;
+        std::vector<std::vector<int>> faces;
+        float angleX, angleY;
+    };
+
+    void reportSharedMeshMemory(std::size_t sphereCount)
+    {
+        const int segments = 20;
+
+        LegacySphereLayout legacy;
+        for (int i = 0; i <= segments; ++i)
+        {
+            for (int j = 0; j <= segments; ++j)
+            {
+                legacy.vertices.push_back({0.0f, 0.0f, 0.0f});
+            }
+        }
+        for (int i = 0; i < segments; ++i)
+        {
+            for (int j = 0; j < segments; ++j)
+            {
+                int i0 = i * (segments + 1) + j;
+                int i2 = (i + 1) * (segments + 1) + j;
+                legacy.faces.push_back({i0, i0 + 1, i2 + 1, i2});
+            }
+        }
+
+        std::size_t legacyBytes = sizeof(LegacySphereLayout) + legacy.vertices.capacity() * sizeof(sf::Vector3f)
+                                + legacy.faces.capacity() * sizeof(std::vector<int>);
+        for (const auto &face: legacy.faces)
+        {
+            legacyBytes += face.capacity() * sizeof(int);
+        }
+        std::size_t legacyAllocations = 2 + legacy.faces.size();
+
+        ObjectStore store;
+        for (std::size_t i = 0; i < sphereCount; ++i)
+        {
+            store.addSphere(1.0f, segments, sf::Vector3f{static_cast<float>(i), 0.0f, 0.0f});
+        }
+        const LodHandle &lods = store.chains.front();
+        const MeshHandle &mesh = lods->levels.front();
+        std::size_t perObjectBytes = 7 * sizeof(float) + sizeof(std::uint32_t) + sizeof(std::uint8_t) + sizeof(std::uint32_t);
+        std::size_t sharedBytes = sphereCount * perObjectBytes + lods->memoryUsage();
+
+        std::printf("%zu spheres (segments = %d): per-object meshes %.2f MiB in %zu allocations, "
+                    "shared meshes %.2f MiB (%zu instances, %zu LOD levels, finest %zu vertices / %zu triangles), saved %.2f MiB\n",
+                    sphereCount, segments,
+                    sphereCount * legacyBytes / 1048576.0, sphereCount * legacyAllocations,
+                    sharedBytes / 1048576.0, store.size(), lods->levels.size(), mesh->vertexCount(), mesh->triangleCount(),
+                    (static_cast<double>(sphereCount * legacyBytes) - sharedBytes) / 1048576.0);
+    }
+
+    // Spheres spread from the camera out to a few thousand units, so their projected radius
+    // ranges from tens of pixels down to a couple.
+    void reportLodSavings(std::size_t sphereCount)
+    {
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> lateral(-2000.0f, 2000.0f);
+        std::uniform_real_distribution<float> depth(0.0f, 3000.0f);
+
+        const sf::Vector3f cameraPosition = {0.0f, 0.0f, 0.0f};
+        ObjectStore store;
+        std::size_t fullVertices = 0, fullFaces = 0, lodVertices = 0, lodFaces = 0;
+        std::vector<std::size_t> levelCounts;
+        for (std::size_t i = 0; i < sphereCount; ++i)
+        {
+            ObjectId sphere = store.addSphere(20.0f, 20, sf::Vector3f{lateral(random), lateral(random), depth(random)});
+
+            fullVertices += store.chain(sphere).levels.front()->vertexCount();
+            fullFaces += store.chain(sphere).levels.front()->triangleCount();
+
+            selectLod(store, sphere, screenRadius(store, sphere, cameraPosition, SCREEN_WIDTH, SCREEN_HEIGHT));
+            lodVertices += store.mesh(sphere).vertexCount();
+            lodFaces += store.mesh(sphere).triangleCount();
+            levelCounts.resize(store.chain(sphere).levels.size());
+            ++levelCounts[store.lods[sphere]];
+        }
+
+        std::printf("LOD %zu spheres: vertices %zu -> %zu, faces %zu -> %zu, objects per level",
+                    sphereCount, fullVertices, lodVertices, fullFaces, lodFaces);
+        for (std::size_t count: levelCounts)
+        {
+            std::printf(" %zu", count);
+        }
+        std::printf("\n");
+
+        // A sphere whose radius wobbles by 10% around a level boundary keeps its level.
+        ObjectId sphere = 0;
+        float boundary = store.chain(sphere).maxScreenRadius[1];
+        selectLod(store, sphere, boundary * 2.0f);
+        std::size_t switches = 0, level = store.lods[sphere];
+        for (int frame = 0; frame < 1000; ++frame)
+        {
+            selectLod(store, sphere, boundary * (frame % 2 == 0 ? 0.95f : 1.05f));
+            switches += store.lods[sphere] != level;
+            level = store.lods[sphere];
+        }
+        std::printf("LOD hysteresis: %zu level switches over 1000 frames oscillating +-5%% around a boundary\n", switches);
+    }
+
+    void benchmarkFaceSort(std::size_t faceCount)
+    {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> depthDistribution(250.0f, 350.0f);
+
+        std::vector<float> depths(faceCount);
+        for (auto &depth: depths)
+        {
+            depth = depthDistribution(random);
+        }
+
+        FaceQueue queue;
+        QueuedFace face = {};
+        auto fill = [&]
+        {
+            queue.clear();
+            for (float depth: depths)
+            {
+                queue.push(face, depth);
+            }
+        };
+
+        // Every iteration is one frame: the queue is refilled and sorted into the buffers
+        // left over from the previous frame.
+        const int frames = 50;
+        auto best = std::chrono::nanoseconds::max();
+        for (int i = 0; i < frames; ++i)
+        {
+            fill();
+            auto start = std::chrono::steady_clock::now();
+            queue.sort();
+            best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+        }
+        double radix = static_cast<double>(best.count());
+
+        bool ordered = true;
+        float bucket = (350.0f - 250.0f) / 65535.0f;
+        for (std::size_t i = 1; i < queue.size(); ++i)
+        {
+            ordered = ordered && queue.depth(queue.sortedIndex(i)) <= queue.depth(queue.sortedIndex(i - 1)) + bucket;
+        }
+
+        std::vector<std::uint32_t> order(faceCount);
+        double comparison = measureNanoseconds([&]
+        {
+            for (std::uint32_t i = 0; i < faceCount; ++i)
+            {
+                order[i] = i;
+            }
+            std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) { return depths[a] > depths[b]; });
+        }, frames);
+
+        std::printf("face sort %8zu faces: radix %7.3f ms/frame, std::sort %7.3f ms/frame, back-to-front %s\n",
+                    faceCount, radix / 1e6, comparison / 1e6, ordered ? "yes" : "NO");
+        expect("radix face sort orders back to front", ordered);
+    }
+
+    // The heap-allocated, virtually dispatched object lab4 used before the ObjectStore,
+    // reduced to what the rotate and transform stages touch.
+    namespace legacy
+    {
+        class Object
+        {
+        public:
+            Object(LodHandle lods, const sf::Vector3f &position):
+                _lods(std::move(lods)), _position(position)
+            {
+
+            }
+
+            virtual ~Object() = default;
+
+            virtual void rotate(float angleX, float angleY)
+            {
+                this->_angleX = angleX;
+                this->_angleY = angleY;
+            }
+
+            void transformVertices(const Matrix4 &viewProjection, VertexStream &worldVertices, VertexStream &screenVertices, std::size_t offset) const
+            {
+                Matrix4 model = Matrix4::translation(_position) * Matrix4::rotationY(_angleY) * Matrix4::rotationX(_angleX);
+                Matrix4 modelViewProjection = viewProjection * model;
+
+                const VertexStream &vertices = mesh()->vertices;
+                std::size_t count = vertices.size();
+                transformPoints(model, vertices.x.data(), vertices.y.data(), vertices.z.data(), count,
+                                worldVertices.x.data() + offset, worldVertices.y.data() + offset, worldVertices.z.data() + offset);
+                projectPoints(modelViewProjection, vertices.x.data(), vertices.y.data(), vertices.z.data(), count,
+                              screenVertices.x.data() + offset, screenVertices.y.data() + offset, screenVertices.z.data() + offset);
+            }
+
+            const MeshHandle &mesh() const { return _lods->levels[_lod]; }
+            float angleX() const { return _angleX; }
+            float angleY() const { return _angleY; }
+
+        protected:
+            LodHandle _lods;
+            std::size_t _lod = 0;
+            sf::Vector3f _position;
+            float _angleX = 0.0f;
+            float _angleY = 0.0f;
+        };
+
+        class Cube: public Object
+        {
+        public:
+            Cube(float size, const sf::Vector3f &position):
+                Object(LodChain::single(MeshLibrary::cube(size)), position)
+            {
+
+            }
+        };
+    }
+
+    // Rotate and transform stages over objectCount cubes, single threaded: the ObjectStore
+    // against a vector of unique_ptr<Object> driven through the old virtual interface.
+    void benchmarkObjectLayout(std::size_t objectCount)
+    {
+        std::mt19937 random(5);
+        std::uniform_real_distribution<float> coordinate(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> spin(-1.0f, 1.0f);
+
+        ObjectStore store;
+        std::vector<std::unique_ptr<legacy::Object>> objects;
+        std::vector<float> spinX, spinY;
+        for (std::size_t i = 0; i < objectCount; ++i)
+        {
+            sf::Vector3f position = {coordinate(random), coordinate(random), coordinate(random)};
+            ObjectId id = store.addCube(1.0f, position);
+            objects.push_back(std::make_unique<legacy::Cube>(1.0f, position));
+
+            spinX.push_back(spin(random));
+            spinY.push_back(spin(random));
+            store.setSpin(id, spinX.back(), spinY.back());
+        }
+
+        const float deltaSeconds = 1.0f / 60.0f;
+        Matrix4 viewProjection = Matrix4::projection(FOV, SCREEN_WIDTH, SCREEN_HEIGHT);
+        std::size_t vertexCount = objectCount * store.mesh(0).vertexCount();
+        VertexStream worldVertices, screenVertices;
+        worldVertices.resize(vertexCount);
+        screenVertices.resize(vertexCount);
+
+        // The stages are timed apart: both sides share the meshes and the batch kernels in
+        // transform, so only rotate shows the cost of the layout and the virtual call.
+        double storeRotate = measureNanoseconds([&]
+        {
+            rotateObjects(store, deltaSeconds, 0, store.size());
+        }, 20);
+        double storeTransform = measureNanoseconds([&]
+        {
+            std::size_t offset = 0;
+            for (ObjectId id = 0; id < store.size(); ++id)
+            {
+                transformObject(store, id, viewProjection, 0, store.mesh(id).vertexCount(), worldVertices, screenVertices, offset);
+                offset += store.mesh(id).vertexCount();
+            }
+        }, 20);
+
+        double legacyRotate = measureNanoseconds([&]
+        {
+            for (std::size_t i = 0; i < objects.size(); ++i)
+            {
+                legacy::Object &object = *objects[i];
+                object.rotate(object.angleX() + spinX[i] * deltaSeconds, object.angleY() + spinY[i] * deltaSeconds);
+            }
+        }, 20);
+        double legacyTransform = measureNanoseconds([&]
+        {
+            std::size_t offset = 0;
+            for (const auto &object: objects)
+            {
+                object->transformVertices(viewProjection, worldVertices, screenVertices, offset);
+                offset += object->mesh()->vertexCount();
+            }
+        }, 20);
+
+        std::printf("rotate %zu cubes: unique_ptr<Object> %7.3f ms, ObjectStore %7.3f ms, speedup %5.2fx\n",
+                    objectCount, legacyRotate / 1e6, storeRotate / 1e6, legacyRotate / storeRotate);
+        std::printf("transform %zu cubes: unique_ptr<Object> %7.3f ms, ObjectStore %7.3f ms, speedup %5.2fx\n",
+                    objectCount, legacyTransform / 1e6, storeTransform / 1e6, legacyTransform / storeTransform);
+    }
+
+    // The diffuse term of shader.frag for one light, evaluated on the CPU.
+    sf::Vector3f shadeLight(const QueuedFace &face, const PointLight &light)
+    {
+        sf::Vector3f toLight = light.position - face.position;
+        float distance = std::sqrt(toLight.x * toLight.x + toLight.y * toLight.y + toLight.z * toLight.z);
+        float falloff = std::min(std::max(1.0f - distance / light.range, 0.0f), 1.0f);
+        float diff = std::max((face.normal.x * toLight.x + face.normal.y * toLight.y + face.normal.z * toLight.z) / distance, 0.0f);
+        return light.color * (diff * falloff * falloff);
+    }
+
+    // Bins lightCount random lights among the spheres of a scene and shades every queued face
+    // once per frame on the CPU, looping over either every light or only the face's cluster.
+    // Also checks that each light reaching a face's shading point is listed in its cluster.
+    void benchmarkClusteredLighting(std::size_t sphereCount, std::size_t lightCount)
+    {
+        const sf::Vector3f cameraPosition = {0.0f, 0.0f, 0.0f};
+        std::mt19937 random(13);
+        std::uniform_real_distribution<float> lateral(-400.0f, 400.0f);
+        std::uniform_real_distribution<float> depth(0.0f, 600.0f);
+
+        Scene scene(1);
+        for (std::size_t i = 0; i < sphereCount; ++i)
+        {
+            scene.objects().addSphere(20.0f, 20, sf::Vector3f{lateral(random), lateral(random), depth(random)});
+        }
+        for (std::size_t i = 0; i < lightCount; ++i)
+        {
+            scene.lights().push_back({{lateral(random), lateral(random), depth(random)}, {0.5f, 0.5f, 0.5f}, 60.0f});
+        }
+        scene.update(cameraPosition, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+        LightClusters clusters;
+        double binning = measureNanoseconds([&]
+        {
+            clusters.build(scene.lights(), cameraPosition, SCREEN_WIDTH, SCREEN_HEIGHT, 1.0f);
+        }, 20);
+
+        const FaceQueue &faces = scene.faceQueue();
+        std::vector<int> faceClusters(faces.size());
+        std::size_t visited = 0, missed = 0;
+        for (std::size_t i = 0; i < faces.size(); ++i)
+        {
+            const QueuedFace &face = faces.sortedFace(i);
+            int cluster = clusters.clusterAt(face.position);
+            faceClusters[i] = cluster;
+            visited += clusters.count(cluster);
+
+            const std::uint32_t *first = clusters.indices().data() + clusters.offset(cluster);
+            const std::uint32_t *last = first + clusters.count(cluster);
+            for (std::uint32_t light = 0; light < clusters.lights().size(); ++light)
+            {
+                sf::Vector3f offset = clusters.lights()[light].position - face.position;
+                float range = clusters.lights()[light].range;
+                if (offset.x * offset.x + offset.y * offset.y + offset.z * offset.z < range * range && std::find(first, last, light) == last)
+                {
+                    ++missed;
+                }
+            }
+        }
+
+        volatile float sink = 0.0f;
+        double bruteForce = measureNanoseconds([&]
+        {
+            for (std::size_t i = 0; i < faces.size(); ++i)
+            {
+                sf::Vector3f result;
+                for (const auto &light: clusters.lights())
+                {
+                    result += shadeLight(faces.sortedFace(i), light);
+                }
+                sink = sink + result.x;
+            }
+        }, 3);
+        double clustered = measureNanoseconds([&]
+        {
+            for (std::size_t i = 0; i < faces.size(); ++i)
+            {
+                sf::Vector3f result;
+                int cluster = faceClusters[i];
+                const std::uint32_t *indices = clusters.indices().data() + clusters.offset(cluster);
+                for (std::uint32_t k = 0; k < clusters.count(cluster); ++k)
+                {
+                    result += shadeLight(faces.sortedFace(i), clusters.lights()[indices[k]]);
+                }
+                sink = sink + result.x;
+            }
+        }, 3);
+
+        std::size_t occupied = clusters.occupiedClusters();
+        std::printf("lights %5zu: binning %6.3f ms, %4zu/%d clusters occupied, %5.1f avg / %3zu max lights per occupied cluster, "
+                    "%6.1f lights per face; shading %zu faces: all lights %8.3f ms, clustered %7.3f ms, %s\n",
+                    lightCount, binning / 1e6, occupied, CLUSTER_COUNT, occupied ? static_cast<double>(clusters.indices().size()) / occupied : 0.0,
+                    clusters.maxLightsPerCluster(), faces.size() ? static_cast<double>(visited) / faces.size() : 0.0,
+                    faces.size(), bruteForce / 1e6, clustered / 1e6, missed ? "MISSED LIGHTS" : "no lights missed");
+        expect("every light reaching a face is in its cluster", missed == 0);
+    }
+
+    // Update phase only (culling, LOD, transform, face emission and sort) for a scene of
+    // spheres in front of the camera, with the job system sized from 1 to maxThreads.
+    void benchmarkParallelUpdate(std::size_t sphereCount, std::size_t maxThreads)
+    {
+        const sf::Vector3f cameraPosition = {0.0f, 0.0f, 0.0f};
+        double singleThread = 0.0;
+
+        // Powers of two, then the machine's own thread count when that is not one of them.
+        std::vector<std::size_t> threadCounts;
+        for (std::size_t threads = 1; threads < maxThreads; threads *= 2)
+        {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(maxThreads);
+
+        for (std::size_t threads: threadCounts)
+        {
+            std::mt19937 random(11);
+            std::uniform_real_distribution<float> lateral(-400.0f, 400.0f);
+            std::uniform_real_distribution<float> depth(0.0f, 600.0f);
+
+            Scene scene(threads);
+            for (std::size_t i = 0; i < sphereCount; ++i)
+            {
+                scene.objects().addSphere(20.0f, 20, sf::Vector3f{lateral(random), lateral(random), depth(random)});
+            }
+
+            double frame = measureNanoseconds([&]
+            {
+                scene.update(cameraPosition, SCREEN_WIDTH, SCREEN_HEIGHT);
+            }, 20);
+            if (threads == 1)
+            {
+                singleThread = frame;
+            }
+
+            // The frames above grew every buffer; a steady frame should not allocate.
+            HeapCounts start = HeapCounts::now();
+            scene.update(cameraPosition, SCREEN_WIDTH, SCREEN_HEIGHT);
+            HeapCounts heap = HeapCounts::now() - start;
+
+            const FrameStats &stats = scene.stats();
+            std::printf("update %zu spheres, %2zu threads: %7.3f ms/frame, speedup %5.2fx (%zu vertices, %zu faces queued), "
+                        "%llu heap allocations in a steady frame\n",
+                        sphereCount, threads, frame / 1e6, singleThread / frame, stats.verticesTransformed,
+                        stats.facesTransformed - stats.facesBackfaceCulled, static_cast<unsigned long long>(heap.allocations));
+        }
+    }
+}
+
+int main()
+{
+#if defined(__AVX__)
+    std::printf("batch kernels: AVX, 8 vertices per iteration\n");
+#elif defined(__SSE2__) || defined(_M_X64)
+    std::printf("batch kernels: SSE, 4 vertices per iteration\n");
+#else
+    std::printf("batch kernels: scalar\n");
+#endif
+
+    for (std::size_t vertexCount: {10000u, 100000u, 1000000u})
+    {
+        benchmarkTransform(vertexCount);
+    }
+
+    reportSharedMeshMemory(10000);
+    reportLodSavings(10000);
+
+    for (std::size_t faceCount: {10000u, 100000u})
+    {
+        benchmarkFaceSort(faceCount);
+    }
+
+    benchmarkObjectLayout(100000);
+    for (std::size_t lightCount: {16u, 64u, 256u, 1024u})
+    {
+        benchmarkClusteredLighting(500, lightCount);
+    }
+
+    benchmarkParallelUpdate(5000, std::max(1u, std::thread::hardware_concurrency()));
+
+    if (failures > 0)
+    {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
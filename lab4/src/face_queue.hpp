@@ -0,0 +1,135 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+struct QueuedFace
+{
+    sf::Vector2f screen[3];
+    sf::Vector3f normal;
+    sf::Vector3f position;
+};
+
+// Frame-wide list of faces gathered from every object and drawn back-to-front, painter's
+// algorithm style. Faces are ordered by an LSD radix sort on their view depth quantized to
+// 16 bits over the depth range seen this frame. All buffers keep their capacity between
+// frames, so a steady scene sorts without allocating.
+class FaceQueue
+{
+public:
+    void clear() noexcept
+    {
+        _faces.clear();
+        _depths.clear();
+        _keys.clear();
+    }
+
+    void push(const QueuedFace &face, float depth)
+    {
+        _faces.push_back(face);
+        _depths.push_back(depth);
+    }
+
+    void append(const QueuedFace *faces, const float *depths, std::size_t count)
+    {
+        _faces.insert(_faces.end(), faces, faces + count);
+        _depths.insert(_depths.end(), depths, depths + count);
+    }
+
+    std::size_t size() const noexcept
+    {
+        return _faces.size();
+    }
+
+    void sort()
+    {
+        std::size_t count = _faces.size();
+        _keys.resize(count);
+        _scratch.resize(count);
+
+        float minDepth = std::numeric_limits<float>::max();
+        float maxDepth = std::numeric_limits<float>::lowest();
+        for (float depth: _depths)
+        {
+            minDepth = std::min(minDepth, depth);
+            maxDepth = std::max(maxDepth, depth);
+        }
+
+        // Farthest face gets key 0, so an ascending sort yields back-to-front order.
+        float range = maxDepth - minDepth;
+        float scale = range > 0.0f ? 65535.0f / range : 0.0f;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto quantized = static_cast<std::uint64_t>((maxDepth - _depths[i]) * scale);
+            _keys[i] = (quantized << 32) | i;
+        }
+
+        for (int shift = 32; shift < 48; shift += 8)
+        {
+            std::size_t offsets[256] = {};
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                ++offsets[(_keys[i] >> shift) & 0xFF];
+            }
+
+            std::size_t total = 0;
+            for (auto &offset: offsets)
+            {
+                std::size_t bucket = offset;
+                offset = total;
+                total += bucket;
+            }
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                _scratch[offsets[(_keys[i] >> shift) & 0xFF]++] = _keys[i];
+            }
+            _keys.swap(_scratch);
+        }
+    }
+
+    // Index of the face to draw at position i after sort().
+    std::size_t sortedIndex(std::size_t i) const noexcept
+    {
+        return static_cast<std::uint32_t>(_keys[i]);
+    }
+
+    const QueuedFace &sortedFace(std::size_t i) const noexcept
+    {
+        return _faces[sortedIndex(i)];
+    }
+
+    float depth(std::size_t index) const noexcept
+    {
+        return _depths[index];
+    }
+
+    // Returns the number of draw calls issued.
+    std::size_t submit(sf::RenderWindow &window, sf::Shader &shader, const sf::Vector3f &cameraPosition) const
+    {
+        shader.setUniform("cameraPosition", sf::Glsl::Vec3(cameraPosition.x, cameraPosition.y, cameraPosition.z));
+
+        for (std::size_t i = 0; i < _keys.size(); ++i)
+        {
+            const QueuedFace &face = sortedFace(i);
+
+            // On the stack rather than an sf::VertexArray, which allocates per face.
+            sf::Vertex triangle[3] = {face.screen[0], face.screen[1], face.screen[2]};
+
+            shader.setUniform("fragNormal", sf::Glsl::Vec3(face.normal.x, face.normal.y, face.normal.z));
+            shader.setUniform("fragPosition", sf::Glsl::Vec3(face.position.x, face.position.y, face.position.z));
+
+            window.draw(triangle, 3, sf::Triangles, &shader);
+        }
+        return _keys.size();
+    }
+
+private:
+    std::vector<QueuedFace> _faces;
+    std::vector<float> _depths;
+    std::vector<std::uint64_t> _keys;
+    std::vector<std::uint64_t> _scratch;
+};
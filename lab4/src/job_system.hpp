@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "profiler.hpp"
+
+// Fixed pool of worker threads with one job queue each. A thread pops new work from the
+// back of its own queue and, when that runs dry, steals the oldest job from the front of
+// another thread's queue. The thread calling parallelFor owns queue 0 and works alongside
+// the pool until its batch is done, so a JobSystem of one thread runs everything inline.
+// Jobs are plain structs in vectors that keep their capacity, so once the queues have
+// grown to the largest batch, parallelFor no longer touches the heap.
+class JobSystem
+{
+public:
+    explicit JobSystem(std::size_t threadCount = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        threadCount = std::max<std::size_t>(threadCount, 1);
+        for (std::size_t i = 0; i < threadCount; ++i)
+        {
+            _queues.push_back(std::make_unique<Queue>());
+        }
+        for (std::size_t i = 1; i < threadCount; ++i)
+        {
+            _workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+            _running = false;
+        }
+        _wake.notify_all();
+        for (auto &worker: _workers)
+        {
+            worker.join();
+        }
+    }
+
+    std::size_t threadCount() const noexcept
+    {
+        return _queues.size();
+    }
+
+    // Calls function(begin, end) over [0, count) in chunks of at most grain items and
+    // returns once every chunk has run. Not reentrant: jobs must not call parallelFor.
+    template<typename Function>
+    void parallelFor(std::size_t count, std::size_t grain, Function &&function)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        grain = std::max<std::size_t>(grain, 1);
+        std::size_t jobCount = (count + grain - 1) / grain;
+        if (jobCount == 1 || _workers.empty())
+        {
+            function(std::size_t(0), count);
+            return;
+        }
+
+        // Counted before the jobs are visible, so a worker that takes one never sees the
+        // pending count underflow.
+        {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+            _pending += jobCount;
+        }
+
+        std::atomic<std::size_t> remaining(jobCount);
+        for (std::size_t job = 0; job < jobCount; ++job)
+        {
+            std::size_t begin = job * grain;
+            std::size_t end = std::min(begin + grain, count);
+            Queue &queue = *_queues[job % _queues.size()];
+
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back({&JobSystem::call<typename std::remove_reference<Function>::type>,
+                                  const_cast<void *>(static_cast<const void *>(&function)), begin, end, &remaining});
+        }
+
+        _wake.notify_all();
+
+        while (remaining.load(std::memory_order_acquire) > 0)
+        {
+            if (!runOne(0))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    // A chunk of some parallelFor call; context points at its function.
+    struct Job
+    {
+        void (*run)(void *context, std::size_t begin, std::size_t end);
+        void *context;
+        std::size_t begin, end;
+        std::atomic<std::size_t> *remaining;
+    };
+
+    // Jobs [head, jobs.size()) are waiting. Cleared once empty, keeping the capacity.
+    struct Queue
+    {
+        std::mutex mutex;
+        std::vector<Job> jobs;
+        std::size_t head = 0;
+    };
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _workers;
+
+    std::mutex _wakeMutex;
+    std::condition_variable _wake;
+    std::atomic<std::size_t> _pending{0};
+    bool _running = true;
+
+    template<typename Function>
+    static void call(void *context, std::size_t begin, std::size_t end)
+    {
+        (*static_cast<Function *>(context))(begin, end);
+    }
+
+    bool runOne(std::size_t self)
+    {
+        Job job;
+        bool found = false;
+        for (std::size_t i = 0; i < _queues.size() && !found; ++i)
+        {
+            Queue &queue = *_queues[(self + i) % _queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.head == queue.jobs.size())
+            {
+                continue;
+            }
+
+            if (i == 0)
+            {
+                job = queue.jobs.back();
+                queue.jobs.pop_back();
+            }
+            else
+            {
+                job = queue.jobs[queue.head++];
+            }
+            if (queue.head == queue.jobs.size())
+            {
+                queue.jobs.clear();
+                queue.head = 0;
+            }
+            found = true;
+        }
+
+        if (!found)
+        {
+            return false;
+        }
+
+        _pending.fetch_sub(1, std::memory_order_relaxed);
+        job.run(job.context, job.begin, job.end);
+        job.remaining->fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    void workerLoop(std::size_t self)
+    {
+        Profiler::instance().nameThread("worker " + std::to_string(self));
+        while (true)
+        {
+            if (runOne(self))
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            _wake.wait(lock, [this] { return _pending.load() > 0 || !_running; });
+            if (!_running)
+            {
+                return;
+            }
+        }
+    }
+};
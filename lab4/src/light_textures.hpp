@@ -0,0 +1,94 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
+#include <vector>
+
+#include "lighting.hpp"
+
+#ifndef GL_RGBA32F
+#define GL_RGBA32F 0x8814
+#endif
+
+// GPU copy of a LightClusters build in two RGBA32F textures read with texelFetch, since
+// GLSL 1.30 has neither buffer textures nor storage buffers:
+//  - lightTexture: two texels per light, (position, range) then (color, 0);
+//  - clusterTexture: one (first, count) texel per cluster, then the light indices four to a
+//    texel. first is the index list position counted in components from the texture start.
+// Both are LIGHT_TEXTURE_WIDTH texels wide and only grow, so a steady scene re-uploads with
+// glTexSubImage2D.
+class LightTextures
+{
+public:
+    static constexpr int LIGHT_TEXTURE_WIDTH = 1024;
+
+    void upload(const LightClusters &clusters)
+    {
+        _lightTexels.clear();
+        for (const auto &light: clusters.lights())
+        {
+            _lightTexels.insert(_lightTexels.end(), {light.position.x, light.position.y, light.position.z, light.range});
+            _lightTexels.insert(_lightTexels.end(), {light.color.x, light.color.y, light.color.z, 0.0f});
+        }
+
+        const auto &indices = clusters.indices();
+        std::size_t indexBase = 4 * static_cast<std::size_t>(CLUSTER_COUNT);
+        _clusterTexels.assign(indexBase + indices.size(), 0.0f);
+        for (int cluster = 0; cluster < CLUSTER_COUNT; ++cluster)
+        {
+            _clusterTexels[4 * cluster] = static_cast<float>(indexBase + clusters.offset(cluster));
+            _clusterTexels[4 * cluster + 1] = static_cast<float>(clusters.count(cluster));
+        }
+        for (std::size_t i = 0; i < indices.size(); ++i)
+        {
+            _clusterTexels[indexBase + i] = static_cast<float>(indices[i]);
+        }
+
+        uploadTexels(_lightTexture, _lightTexels);
+        uploadTexels(_clusterTexture, _clusterTexels);
+    }
+
+    void apply(sf::Shader &shader, const LightClusters &clusters, int screenWidth, int screenHeight, float nearDepth) const
+    {
+        shader.setUniform("lightTexture", _lightTexture);
+        shader.setUniform("clusterTexture", _clusterTexture);
+        shader.setUniform("textureWidth", LIGHT_TEXTURE_WIDTH);
+        shader.setUniform("screenSize", sf::Glsl::Vec2(static_cast<float>(screenWidth), static_cast<float>(screenHeight)));
+        shader.setUniform("fov", FOV);
+        shader.setUniform("clusterGrid", sf::Glsl::Ivec3(CLUSTER_COLUMNS, CLUSTER_ROWS, CLUSTER_SLICES));
+        shader.setUniform("clusterNear", nearDepth);
+        shader.setUniform("clusterSliceScale", clusters.sliceScale());
+    }
+
+private:
+    sf::Texture _lightTexture;
+    sf::Texture _clusterTexture;
+    std::vector<float> _lightTexels;
+    std::vector<float> _clusterTexels;
+
+    // texels holds four floats per texel and is padded here to whole rows.
+    static void uploadTexels(sf::Texture &texture, std::vector<float> &texels)
+    {
+        std::size_t rowFloats = 4 * static_cast<std::size_t>(LIGHT_TEXTURE_WIDTH);
+        std::size_t rows = std::max<std::size_t>(1, (texels.size() + rowFloats - 1) / rowFloats);
+        texels.resize(rows * rowFloats, 0.0f);
+
+        // sf::Texture only allocates RGBA8, so new storage is respecified as float.
+        bool grow = texture.getSize().y < rows;
+        if (grow)
+        {
+            texture.create(LIGHT_TEXTURE_WIDTH, static_cast<unsigned>(rows));
+        }
+
+        sf::Texture::bind(&texture);
+        if (grow)
+        {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, LIGHT_TEXTURE_WIDTH, static_cast<GLsizei>(rows), 0, GL_RGBA, GL_FLOAT, texels.data());
+        }
+        else
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, LIGHT_TEXTURE_WIDTH, static_cast<GLsizei>(rows), GL_RGBA, GL_FLOAT, texels.data());
+        }
+        sf::Texture::bind(nullptr);
+    }
+};
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <SFML/System/Vector3.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "systems.hpp"
+
+struct PointLight
+{
+    sf::Vector3f position;
+    sf::Vector3f color = {0.8f, 0.8f, 0.8f};
+    float range = 1.0f;
+    bool enabled = true;
+};
+
+// The view volume is cut into CLUSTER_COLUMNS x CLUSTER_ROWS screen tiles and CLUSTER_SLICES
+// slices of w (the projection divisor, view z + FOV), spaced logarithmically from the near
+// plane to CLUSTER_FAR_DEPTH.
+constexpr int CLUSTER_COLUMNS = 16;
+constexpr int CLUSTER_ROWS = 12;
+constexpr int CLUSTER_SLICES = 32;
+constexpr int CLUSTER_COUNT = CLUSTER_COLUMNS * CLUSTER_ROWS * CLUSTER_SLICES;
+constexpr float CLUSTER_FAR_DEPTH = 4096.0f;
+
+// Bins the enabled lights into every cluster their range sphere may reach and keeps one
+// compact index list per cluster, so shading a point only visits the lights of its cluster.
+// Points nearer than the near plane or past the last slice clamp into the first or last
+// slice, and off-screen points into the edge tiles; the binning clamps the same way, so a
+// lookup never misses a light that reaches the point. Lights entirely behind the near plane
+// are dropped.
+class LightClusters
+{
+public:
+    void build(const std::vector<PointLight> &lights, const sf::Vector3f &cameraPosition, int screenWidth, int screenHeight, float nearDepth)
+    {
+        _cameraPosition = cameraPosition;
+        _screenWidth = static_cast<float>(screenWidth);
+        _screenHeight = static_cast<float>(screenHeight);
+        _nearDepth = nearDepth;
+        _sliceScale = CLUSTER_SLICES / std::log(CLUSTER_FAR_DEPTH / nearDepth);
+
+        _lights.clear();
+        for (const auto &light: lights)
+        {
+            if (light.enabled && light.range > 0.0f)
+            {
+                _lights.push_back(light);
+            }
+        }
+
+        // Counting pass, prefix sum, then a filling pass into one flat index list.
+        _offsets.assign(CLUSTER_COUNT + 1, 0);
+        for (std::size_t i = 0; i < _lights.size(); ++i)
+        {
+            forEachCluster(_lights[i], [this](int cluster) { ++_offsets[cluster + 1]; });
+        }
+        for (int cluster = 0; cluster < CLUSTER_COUNT; ++cluster)
+        {
+            _offsets[cluster + 1] += _offsets[cluster];
+        }
+
+        _indices.resize(_offsets[CLUSTER_COUNT]);
+        _cursor.assign(_offsets.begin(), _offsets.end() - 1);
+        for (std::size_t i = 0; i < _lights.size(); ++i)
+        {
+            forEachCluster(_lights[i], [this, i](int cluster) { _indices[_cursor[cluster]++] = static_cast<std::uint32_t>(i); });
+        }
+    }
+
+    // Cluster that shades a world-space point; the shader computes the same index.
+    int clusterAt(const sf::Vector3f &position) const noexcept
+    {
+        float x = position.x - _cameraPosition.x;
+        float y = position.y - _cameraPosition.y;
+        float w = std::max(position.z - _cameraPosition.z + FOV, 1e-6f);
+        int column = clampCell(columnAt(x / w), CLUSTER_COLUMNS);
+        int row = clampCell(rowAt(y / w), CLUSTER_ROWS);
+        int slice = sliceAt(w);
+        return (slice * CLUSTER_ROWS + row) * CLUSTER_COLUMNS + column;
+    }
+
+    // Enabled lights in the order the index lists refer to them.
+    const std::vector<PointLight> &lights() const noexcept
+    {
+        return _lights;
+    }
+
+    const std::vector<std::uint32_t> &indices() const noexcept
+    {
+        return _indices;
+    }
+
+    std::uint32_t offset(int cluster) const noexcept
+    {
+        return _offsets[cluster];
+    }
+
+    std::uint32_t count(int cluster) const noexcept
+    {
+        return _offsets[cluster + 1] - _offsets[cluster];
+    }
+
+    std::size_t occupiedClusters() const noexcept
+    {
+        std::size_t occupied = 0;
+        for (int cluster = 0; cluster < CLUSTER_COUNT; ++cluster)
+        {
+            occupied += count(cluster) > 0;
+        }
+        return occupied;
+    }
+
+    std::size_t maxLightsPerCluster() const noexcept
+    {
+        std::uint32_t most = 0;
+        for (int cluster = 0; cluster < CLUSTER_COUNT; ++cluster)
+        {
+            most = std::max(most, count(cluster));
+        }
+        return most;
+    }
+
+    float sliceScale() const noexcept
+    {
+        return _sliceScale;
+    }
+
+private:
+    std::vector<PointLight> _lights;
+    std::vector<std::uint32_t> _offsets;
+    std::vector<std::uint32_t> _cursor;
+    std::vector<std::uint32_t> _indices;
+
+    sf::Vector3f _cameraPosition;
+    float _screenWidth = 0.0f;
+    float _screenHeight = 0.0f;
+    float _nearDepth = 1.0f;
+    float _sliceScale = 1.0f;
+
+    // Tile coordinates of a point given its x / w or y / w, before clamping.
+    float columnAt(float xOverW) const noexcept
+    {
+        float aspectRatio = _screenWidth / _screenHeight;
+        return (xOverW * FOV * aspectRatio + _screenWidth * 0.5f) * CLUSTER_COLUMNS / _screenWidth;
+    }
+
+    float rowAt(float yOverW) const noexcept
+    {
+        return (yOverW * FOV + _screenHeight * 0.5f) * CLUSTER_ROWS / _screenHeight;
+    }
+
+    static int clampCell(float cell, int cells) noexcept
+    {
+        return static_cast<int>(std::min(std::max(std::floor(cell), 0.0f), static_cast<float>(cells - 1)));
+    }
+
+    int sliceAt(float w) const noexcept
+    {
+        return w < _nearDepth ? 0 : clampCell(std::log(w / _nearDepth) * _sliceScale, CLUSTER_SLICES);
+    }
+
+    float sliceStart(int slice) const noexcept
+    {
+        return _nearDepth * std::exp(slice / _sliceScale);
+    }
+
+    // Visits every cluster the light's range sphere may touch. Within each slice the sphere's
+    // bounding box is projected at both ends of the slice's w range, which bounds x / w and
+    // y / w for every point of the box in that slice.
+    template<typename Visit>
+    void forEachCluster(const PointLight &light, Visit &&visit) const
+    {
+        // Slack for the float rounding between this and the shader's cluster lookup.
+        const float SLICE_SLACK = 1e-4f;
+        const float CELL_SLACK = 1e-3f;
+
+        float x = light.position.x - _cameraPosition.x;
+        float y = light.position.y - _cameraPosition.y;
+        float w = light.position.z - _cameraPosition.z + FOV;
+        float minW = w - light.range;
+        float maxW = w + light.range;
+        if (maxW < _nearDepth)
+        {
+            return;
+        }
+
+        int firstSlice = sliceAt(std::max(minW, _nearDepth));
+        int lastSlice = sliceAt(maxW);
+        for (int slice = firstSlice; slice <= lastSlice; ++slice)
+        {
+            int firstColumn = 0, lastColumn = CLUSTER_COLUMNS - 1;
+            int firstRow = 0, lastRow = CLUSTER_ROWS - 1;
+
+            // Points nearer than the near plane land in slice 0 at any tile.
+            if (slice != 0 || minW >= _nearDepth)
+            {
+                float nearW = std::max(minW, slice == 0 ? _nearDepth : sliceStart(slice) * (1.0f - SLICE_SLACK));
+                float farW = slice == CLUSTER_SLICES - 1 ? maxW : std::min(maxW, sliceStart(slice + 1) * (1.0f + SLICE_SLACK));
+
+                float left = std::min((x - light.range) / nearW, (x - light.range) / farW);
+                float right = std::max((x + light.range) / nearW, (x + light.range) / farW);
+                float top = std::min((y - light.range) / nearW, (y - light.range) / farW);
+                float bottom = std::max((y + light.range) / nearW, (y + light.range) / farW);
+
+                firstColumn = clampCell(columnAt(left) - CELL_SLACK, CLUSTER_COLUMNS);
+                lastColumn = clampCell(columnAt(right) + CELL_SLACK, CLUSTER_COLUMNS);
+                firstRow = clampCell(rowAt(top) - CELL_SLACK, CLUSTER_ROWS);
+                lastRow = clampCell(rowAt(bottom) + CELL_SLACK, CLUSTER_ROWS);
+            }
+
+            for (int row = firstRow; row <= lastRow; ++row)
+            {
+                for (int column = firstColumn; column <= lastColumn; ++column)
+                {
+                    visit((slice * CLUSTER_ROWS + row) * CLUSTER_COLUMNS + column);
+                }
+            }
+        }
+    }
+};
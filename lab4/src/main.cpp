@@ -3,335 +3,14 @@
 #include <cmath>
 #include <iostream>
 #include <memory>
+#include <random>
+#include <string>
 
-class Object 
-{
-public:
-    virtual void draw(sf::RenderWindow &window, sf::Shader &shader, const sf::Vector3f &cameraPosition, const sf::Vector3f &lightPosition1, const sf::Vector3f &lightPosition2, bool enableLight1, bool enableLight2) = 0;
-    virtual void rotate(float angleX, float angleY) = 0;
-    virtual void setPosition(const sf::Vector3f &position) { this->_position = position; }
-    virtual ~Object() = default;
-
-protected:
-    sf::Vector3f _position;
-    int _screenWidth, _screenHeight;
-    std::vector<sf::Vector3f> _vertices;
-    std::vector<std::vector<int>> _faces;
-
-    std::vector<sf::Vector3f> rotateVertices(float angleX, float angleY) 
-    {
-        std::vector<sf::Vector3f> rotatedVertices;
-        float cosX = std::cos(angleX);
-        float sinX = std::sin(angleX);
-        float cosY = std::cos(angleY);
-        float sinY = std::sin(angleY);
-
-        for (const auto &vertex: _vertices) 
-        {
-            float x = vertex.x;
-            float y = vertex.y;
-            float z = vertex.z;
-
-            float y1 = y * cosX - z * sinX;
-            float z1 = y * sinX + z * cosX;
-
-            float x1 = x * cosY + z1 * sinY;
-            float z2 = -x * sinY + z1 * cosY;
-
-            rotatedVertices.push_back({x1, y1, z2});
-        }
-
-        return rotatedVertices;
-    }
-
-    std::vector<sf::Vector2f> projectVertices(const std::vector<sf::Vector3f> &vertices, const sf::Vector3f &cameraPosition) 
-    {
-        std::vector<sf::Vector2f> projectedVertices;
-        float fov = 256.0f;
-        float aspectRatio = static_cast<float>(_screenWidth) / _screenHeight;
-
-        for (const auto &vertex: vertices) 
-        {
-            float x = vertex.x + _position.x - cameraPosition.x;
-            float y = vertex.y + _position.y - cameraPosition.y;
-            float z = vertex.z + _position.z - cameraPosition.z;
-
-            float zInv = 1.0f / (z + fov);
-            float xProj = x * zInv * fov * aspectRatio + _screenWidth / 2;
-            float yProj = y * zInv * fov + _screenHeight / 2;
-
-            projectedVertices.push_back({xProj, yProj});
-        }
-
-        return projectedVertices;
-    }
-
-    sf::Vector3f calculateNormal(const sf::Vector3f &v1, const sf::Vector3f &v2, const sf::Vector3f &v3) 
-    {
-        sf::Vector3f edge1 = {v2.x - v1.x, v2.y - v1.y, v2.z - v1.z};
-        sf::Vector3f edge2 = {v3.x - v1.x, v3.y - v1.y, v3.z - v1.z};
-
-        sf::Vector3f normal = 
-        {
-            edge1.y * edge2.z - edge1.z * edge2.y,
-            edge1.z * edge2.x - edge1.x * edge2.z,
-            edge1.x * edge2.y - edge1.y * edge2.x
-        };
-
-        float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
-        normal.x /= length;
-        normal.y /= length;
-        normal.z /= length;
-
-        return normal;
-    }
-
-    float dotProduct(const sf::Vector3f &v1, const sf::Vector3f &v2) 
-    {
-        return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
-    }
-};
-
-class Cube: public Object {
-public:
-    
-    Cube(float size, sf::Vector3f position, int screenWidth, int screenHeight) 
-    {
-        this->_position = position;
-        this->_screenWidth = screenWidth;
-        this->_screenHeight = screenHeight;
-
-        _vertices = 
-        {
-            {-size, -size, -size},
-            { size, -size, -size},
-            { size,  size, -size},
-            {-size,  size, -size},
-            {-size, -size,  size},
-            { size, -size,  size},
-            { size,  size,  size},
-            {-size,  size,  size}
-        };
-
-        _faces = 
-        {
-            {0, 1, 2, 3},
-            {1, 5, 6, 2},
-            {5, 4, 7, 6},
-            {4, 0, 3, 7},
-            {0, 1, 5, 4},
-            {3, 2, 6, 7}
-        };
-    }
-
-    void draw(sf::RenderWindow &window, sf::Shader &shader, const sf::Vector3f &cameraPosition, const sf::Vector3f &lightPosition1, const sf::Vector3f &lightPosition2, bool enableLight1, bool enableLight2) override 
-    {
-        std::vector<sf::Vector3f> rotatedVertices = rotateVertices(angleX, angleY);
-        std::vector<sf::Vector2f> projectedVertices = projectVertices(rotatedVertices, cameraPosition);
-
-        for (const auto &face: _faces)
-         {
-            sf::VertexArray quad(sf::Quads, 4);
-            for (int i = 0; i < 4; ++i) 
-            {
-                quad[i].position = projectedVertices[face[i]];
-            }
-
-            sf::Vector3f normal = calculateNormal(rotatedVertices[face[0]], rotatedVertices[face[1]], rotatedVertices[face[2]]);
-
-            shader.setUniform("fragNormal", sf::Glsl::Vec3(normal.x, normal.y, normal.z));
-            shader.setUniform("fragPosition", sf::Glsl::Vec3(rotatedVertices[face[0]].x, rotatedVertices[face[0]].y, rotatedVertices[face[0]].z));
-            shader.setUniform("lightPosition1", sf::Glsl::Vec3(lightPosition1.x, lightPosition1.y, lightPosition1.z));
-            shader.setUniform("lightPosition2", sf::Glsl::Vec3(lightPosition2.x, lightPosition2.y, lightPosition2.z));
-            shader.setUniform("cameraPosition", sf::Glsl::Vec3(cameraPosition.x, cameraPosition.y, cameraPosition.z));
-            shader.setUniform("enableLight1", enableLight1);
-            shader.setUniform("enableLight2", enableLight2);
-
-            window.draw(quad, &shader);
-        }
-    }
-
-    void rotate(float angleX, float angleY) override 
-    {
-        this->angleX = angleX;
-        this->angleY = angleY;
-    }
-
-private:
-    float angleX = 0.0f, angleY = 0.0f;
-};
-
-class Sphere: 
-    public Object 
-{
-
-public:
-    Sphere(float radius, int segments, sf::Vector3f position, int screenWidth, int screenHeight) 
-    {
-        this->_position = position;
-        this->_screenWidth = screenWidth;
-        this->_screenHeight = screenHeight;
-
-        for (int i = 0; i <= segments; ++i) 
-        {
-            float lat = i * M_PI / segments - M_PI / 2;
-            float sinLat = std::sin(lat);
-            float cosLat = std::cos(lat);
-
-            for (int j = 0; j <= segments; ++j) 
-            {
-                float lon = j * 2 * M_PI / segments;
-                float sinLon = std::sin(lon);
-                float cosLon = std::cos(lon);
-
-                float x = radius * cosLat * cosLon;
-                float y = radius * sinLat;
-                float z = radius * cosLat * sinLon;
-
-                _vertices.push_back({x, y, z});
-            }
-        }
-
-        for (int i = 0; i < segments; ++i) 
-        {
-            for (int j = 0; j < segments; ++j) 
-            {
-                int i0 = i * (segments + 1) + j;
-                int i1 = i0 + 1;
-                int i2 = (i + 1) * (segments + 1) + j;
-                int i3 = i2 + 1;
-
-                _faces.push_back({i0, i1, i3, i2});
-            }
-        }
-    }
-
-    void draw(sf::RenderWindow &window, sf::Shader &shader, const sf::Vector3f &cameraPosition, const sf::Vector3f &lightPosition1, const sf::Vector3f &lightPosition2, bool enableLight1, bool enableLight2) override 
-    {
-        std::vector<sf::Vector3f> rotatedVertices = rotateVertices(angleX, angleY);
-        std::vector<sf::Vector2f> projectedVertices = projectVertices(rotatedVertices, cameraPosition);
-
-        for (const auto &face: _faces) 
-        {
-            sf::VertexArray quad(sf::Quads, 4);
-            for (int i = 0; i < 4; ++i) 
-            {
-                quad[i].position = projectedVertices[face[i]];
-            }
-
-            sf::Vector3f normal = calculateNormal(rotatedVertices[face[0]], rotatedVertices[face[1]], rotatedVertices[face[2]]);
-
-            shader.setUniform("fragNormal", sf::Glsl::Vec3(normal.x, normal.y, normal.z));
-            shader.setUniform("fragPosition", sf::Glsl::Vec3(rotatedVertices[face[0]].x, rotatedVertices[face[0]].y, rotatedVertices[face[0]].z));
-            shader.setUniform("lightPosition1", sf::Glsl::Vec3(lightPosition1.x, lightPosition1.y, lightPosition1.z));
-            shader.setUniform("lightPosition2", sf::Glsl::Vec3(lightPosition2.x, lightPosition2.y, lightPosition2.z));
-            shader.setUniform("cameraPosition", sf::Glsl::Vec3(cameraPosition.x, cameraPosition.y, cameraPosition.z));
-            shader.setUniform("enableLight1", enableLight1);
-            shader.setUniform("enableLight2", enableLight2);
-
-            window.draw(quad, &shader);
-        }
-    }
-
-    void rotate(float angleX, float angleY) override 
-    {
-        this->angleX = angleX;
-        this->angleY = angleY;
-    }
-
-private:
-    float angleX = 0.0f, angleY = 0.0f;
-};
-
-class Pyramid: 
-    public Object 
-{
-
-public:
-    Pyramid(float size, sf::Vector3f position, int screenWidth, int screenHeight) 
-    {
-        this->_position = position;
-        this->_screenWidth = screenWidth;
-        this->_screenHeight = screenHeight;
-
-        _vertices = 
-        {
-            {-size, -size, -size},
-            { size, -size, -size},
-            { size, -size,  size},
-            {-size, -size,  size},
-            {0.0f,  size, 0.0f}
-        };
-
-        _faces = 
-        {
-            {0, 1, 4},
-            {1, 2, 4},
-            {2, 3, 4},
-            {3, 0, 4},
-            {0, 1, 2, 3}
-        };
-    }
-
-    void draw(sf::RenderWindow &window, sf::Shader &shader, const sf::Vector3f &cameraPosition, const sf::Vector3f &lightPosition1, const sf::Vector3f &lightPosition2, bool enableLight1, bool enableLight2) override 
-    {
-        std::vector<sf::Vector3f> rotatedVertices = rotateVertices(angleX, angleY);
-        std::vector<sf::Vector2f> projectedVertices = projectVertices(rotatedVertices, cameraPosition);
-
-        for (const auto &face: _faces) 
-        {
-            if (face.size() == 3) 
-            {
-                sf::VertexArray triangle(sf::Triangles, 3);
-                for (int i = 0; i < 3; ++i) 
-                {
-                    triangle[i].position = projectedVertices[face[i]];
-                }
-
-                sf::Vector3f normal = calculateNormal(rotatedVertices[face[0]], rotatedVertices[face[1]], rotatedVertices[face[2]]);
-
-                shader.setUniform("fragNormal", sf::Glsl::Vec3(normal.x, normal.y, normal.z));
-                shader.setUniform("fragPosition", sf::Glsl::Vec3(rotatedVertices[face[0]].x, rotatedVertices[face[0]].y, rotatedVertices[face[0]].z));
-                shader.setUniform("lightPosition1", sf::Glsl::Vec3(lightPosition1.x, lightPosition1.y, lightPosition1.z));
-                shader.setUniform("lightPosition2", sf::Glsl::Vec3(lightPosition2.x, lightPosition2.y, lightPosition2.z));
-                shader.setUniform("cameraPosition", sf::Glsl::Vec3(cameraPosition.x, cameraPosition.y, cameraPosition.z));
-                shader.setUniform("enableLight1", enableLight1);
-                shader.setUniform("enableLight2", enableLight2);
-
-                window.draw(triangle, &shader);
-            } 
-            else if (face.size() == 4) 
-            {
-                sf::VertexArray quad(sf::Quads, 4);
-                for (int i = 0; i < 4; ++i) 
-                {
-                    quad[i].position = projectedVertices[face[i]];
-                }
-
-                sf::Vector3f normal = calculateNormal(rotatedVertices[face[0]], rotatedVertices[face[1]], rotatedVertices[face[2]]);
-
-                shader.setUniform("fragNormal", sf::Glsl::Vec3(normal.x, normal.y, normal.z));
-                shader.setUniform("fragPosition", sf::Glsl::Vec3(rotatedVertices[face[0]].x, rotatedVertices[face[0]].y, rotatedVertices[face[0]].z));
-                shader.setUniform("lightPosition1", sf::Glsl::Vec3(lightPosition1.x, lightPosition1.y, lightPosition1.z));
-                shader.setUniform("lightPosition2", sf::Glsl::Vec3(lightPosition2.x, lightPosition2.y, lightPosition2.z));
-                shader.setUniform("cameraPosition", sf::Glsl::Vec3(cameraPosition.x, cameraPosition.y, cameraPosition.z));
-                shader.setUniform("enableLight1", enableLight1);
-                shader.setUniform("enableLight2", enableLight2);
-
-                window.draw(quad, &shader);
-            }
-        }
-    }
-
-    void rotate(float angleX, float angleY) override 
-    {
-        this->angleX = angleX;
-        this->angleY = angleY;
-    }
-
-private:
-    float angleX = 0.0f, angleY = 0.0f;
-};
+#include "allocation_hooks.hpp"
+#include "frame_recorder.hpp"
+#include "metrics_server.hpp"
+#include "profiler_overlay.hpp"
+#include "scene.hpp"
 
 int main() {
     sf::RenderWindow window(sf::VideoMode(800, 600), "FOURTH LAB");
@@ -345,22 +24,50 @@ int main() {
     }
 
     sf::Vector3f cameraPosition = {0.0f, 0.0f, -5.0f};
-    sf::Vector3f lightPosition1 = {2.0f, 2.0f, -2.0f};
-    sf::Vector3f lightPosition2 = {-2.0f, -2.0f, -2.0f};
     float cameraSpeed = 1.0f;
 
-    bool enableLight1 = true;
-    bool enableLight2 = true;
+    Scene scene;
+    scene.objects().addCube(1.0f, sf::Vector3f{0.0f, 0.0f, 0.0f});
+    scene.objects().addSphere(1.0f, 20, sf::Vector3f{3.0f, 0.0f, 0.0f});
+    scene.objects().addPyramid(1.0f, sf::Vector3f{-3.0f, 0.0f, 0.0f});
+
+    // Two key lights that reach the whole scene, toggled with 1 and 2, plus short-range
+    // colored fill lights scattered around the objects.
+    scene.lights().push_back({{2.0f, 2.0f, -2.0f}, {0.8f, 0.8f, 0.8f}, 1000.0f});
+    scene.lights().push_back({{-2.0f, -2.0f, -2.0f}, {0.8f, 0.8f, 0.8f}, 1000.0f});
 
-    std::unique_ptr<Object> cube = std::make_unique<Cube>(1.0f, sf::Vector3f{0.0f, 0.0f, 0.0f}, window.getSize().x, window.getSize().y);
-    std::unique_ptr<Object> sphere = std::make_unique<Sphere>(1.0f, 20, sf::Vector3f{3.0f, 0.0f, 0.0f}, window.getSize().x, window.getSize().y);
-    std::unique_ptr<Object> pyramid = std::make_unique<Pyramid>(1.0f, sf::Vector3f{-3.0f, 0.0f, 0.0f}, window.getSize().x, window.getSize().y);
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> spread(-5.0f, 5.0f);
+    std::uniform_real_distribution<float> channel(0.0f, 0.6f);
+    for (int i = 0; i < 256; ++i)
+    {
+        scene.lights().push_back({{spread(random), spread(random) * 0.5f, spread(random) * 0.5f}, {channel(random), channel(random), channel(random)}, 1.5f});
+    }
+
+    sf::Clock frameClock;
+    sf::Clock statsClock;
+    ProfilerOverlay overlay("lab4_trace.json");
+    FrameRecorder recorder("lab4_capture");
+    FrameHeapMeter heapMeter;
+
+    // Served while METRICS_ADDRESS is set, e.g. METRICS_ADDRESS=9100.
+    MetricRegistry metrics;
+    Histogram &frameSeconds = metrics.histogram("lab4_frame_seconds", "Time between consecutive frames.", Histogram::exponentialBounds(0.001, 2, 12));
+    Counter &drawCalls = metrics.counter("lab4_draw_calls_total", "Draw calls issued.");
+    Counter &facesSubmitted = metrics.counter("lab4_faces_submitted_total", "Faces drawn after culling.");
+    Counter &facesFrustumCulled = metrics.counter("lab4_faces_culled_total", "Faces dropped before drawing, by the test that dropped them.", "reason=\"frustum\"");
+    Counter &facesBackfaceCulled = metrics.counter("lab4_faces_culled_total", "Faces dropped before drawing, by the test that dropped them.", "reason=\"backface\"");
+    std::unique_ptr<MetricsServer> metricsServer = startMetricsServer(metrics);
 
     while (window.isOpen()) 
     {
+        heapMeter.beginFrame();
+        PROFILE_ZONE("frame");
         sf::Event event;
         while (window.pollEvent(event)) 
         {
+            overlay.handleEvent(event);
+            recorder.handleEvent(event);
             if (event.type == sf::Event::Closed)
             {
                 window.close();
@@ -386,20 +93,50 @@ int main() {
 
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num1)) 
         {
-            enableLight1 = !enableLight1;
+            scene.lights()[0].enabled = !scene.lights()[0].enabled;
         }
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num2)) 
         {
-            enableLight2 = !enableLight2;
+            scene.lights()[1].enabled = !scene.lights()[1].enabled;
         }
 
         window.clear();
 
-        cube->draw(window, shader, cameraPosition, lightPosition1, lightPosition2, enableLight1, enableLight2);
-        sphere->draw(window, shader, cameraPosition, lightPosition1, lightPosition2, enableLight1, enableLight2);
-        pyramid->draw(window, shader, cameraPosition, lightPosition1, lightPosition2, enableLight1, enableLight2);
+        float frameTime = frameClock.restart().asSeconds();
+        scene.animate(frameTime);
+        scene.draw(window, shader, cameraPosition);
+        recorder.capture(window);
+        overlay.draw(window);
+
+        const FrameStats &frameStats = scene.stats();
+        frameSeconds.observe(frameTime);
+        drawCalls.add(frameStats.drawCalls);
+        facesSubmitted.add(frameStats.facesSubmitted);
+        facesFrustumCulled.add(frameStats.facesFrustumCulled);
+        facesBackfaceCulled.add(frameStats.facesBackfaceCulled);
 
-        window.display();
+        {
+            PROFILE_ZONE("display");
+            window.display();
+        }
+        overlay.update();
+        heapMeter.endFrame();
+
+        if (statsClock.getElapsedTime().asSeconds() >= 1.0f)
+        {
+            const FrameStats &stats = scene.stats();
+            FrameHeapMeter::Summary heap = heapMeter.take();
+            window.setTitle("FOURTH LAB | vertices " + std::to_string(stats.verticesTransformed) +
+                            ", faces " + std::to_string(stats.facesTransformed) +
+                            ", submitted " + std::to_string(stats.facesSubmitted) +
+                            ", frustum-culled " + std::to_string(stats.facesFrustumCulled) +
+                            ", back-face-culled " + std::to_string(stats.facesBackfaceCulled) +
+                            ", lights " + std::to_string(stats.lightsBinned) +
+                            ", max per cluster " + std::to_string(stats.maxLightsPerCluster) +
+                            ", heap allocations per frame " + std::to_string(heap.allocations / heap.frames) +
+                            " (max " + std::to_string(heap.maxAllocations) + ", " + std::to_string(heap.bytes / heap.frames) + " bytes)");
+            statsClock.restart();
+        }
     }
 
     return 0;
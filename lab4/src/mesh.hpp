@@ -0,0 +1,255 @@
+#pragma once
+
+#include <SFML/System/Vector3.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "transform.hpp"
+
+// Immutable triangle mesh: one flat vertex stream and one flat index buffer with three
+// indices per triangle. Triangles are wound so that (v1 - v0) x (v2 - v0) points outward.
+struct Mesh
+{
+    VertexStream vertices;
+    std::vector<std::uint32_t> indices;
+    float boundingRadius = 0.0f;
+
+    std::size_t vertexCount() const noexcept
+    {
+        return vertices.size();
+    }
+
+    std::size_t triangleCount() const noexcept
+    {
+        return indices.size() / 3;
+    }
+
+    std::size_t memoryUsage() const noexcept
+    {
+        return sizeof(Mesh) + 3 * vertices.x.capacity() * sizeof(float) + indices.capacity() * sizeof(std::uint32_t);
+    }
+};
+
+using MeshHandle = std::shared_ptr<const Mesh>;
+
+// Tessellations of one shape from finest to coarsest. maxScreenRadius[i] is the projected
+// radius in pixels up to which level i still looks smooth.
+struct LodChain
+{
+    std::vector<MeshHandle> levels;
+    std::vector<float> maxScreenRadius;
+
+    static std::shared_ptr<const LodChain> single(MeshHandle mesh)
+    {
+        auto chain = std::make_shared<LodChain>();
+        chain->levels.push_back(std::move(mesh));
+        chain->maxScreenRadius.push_back(std::numeric_limits<float>::max());
+        return chain;
+    }
+
+    std::size_t memoryUsage() const noexcept
+    {
+        std::size_t bytes = sizeof(LodChain) + maxScreenRadius.capacity() * sizeof(float);
+        for (const auto &level: levels)
+        {
+            bytes += sizeof(MeshHandle) + level->memoryUsage();
+        }
+        return bytes;
+    }
+};
+
+using LodHandle = std::shared_ptr<const LodChain>;
+
+class MeshBuilder
+{
+public:
+    void addVertex(const sf::Vector3f &vertex)
+    {
+        _vertices.push_back(vertex);
+    }
+
+    // Degenerate triangles (the pole rows of a UV sphere) have no normal and are dropped.
+    void addTriangle(std::uint32_t a, std::uint32_t b, std::uint32_t c)
+    {
+        sf::Vector3f edge1 = _vertices[b] - _vertices[a];
+        sf::Vector3f edge2 = _vertices[c] - _vertices[a];
+        float nx = edge1.y * edge2.z - edge1.z * edge2.y;
+        float ny = edge1.z * edge2.x - edge1.x * edge2.z;
+        float nz = edge1.x * edge2.y - edge1.y * edge2.x;
+        float edgeScale = std::max(edge1.x * edge1.x + edge1.y * edge1.y + edge1.z * edge1.z, edge2.x * edge2.x + edge2.y * edge2.y + edge2.z * edge2.z);
+        if (nx * nx + ny * ny + nz * nz <= 1e-10f * edgeScale * edgeScale)
+        {
+            return;
+        }
+
+        _indices.push_back(a);
+        _indices.push_back(b);
+        _indices.push_back(c);
+    }
+
+    void addQuad(std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d)
+    {
+        addTriangle(a, b, c);
+        addTriangle(a, c, d);
+    }
+
+    MeshHandle build()
+    {
+        auto mesh = std::make_shared<Mesh>();
+        mesh->vertices = VertexStream(_vertices);
+        mesh->indices = std::move(_indices);
+        mesh->indices.shrink_to_fit();
+        for (const auto &vertex: _vertices)
+        {
+            mesh->boundingRadius = std::max(mesh->boundingRadius, std::sqrt(vertex.x * vertex.x + vertex.y * vertex.y + vertex.z * vertex.z));
+        }
+        return mesh;
+    }
+
+private:
+    std::vector<sf::Vector3f> _vertices;
+    std::vector<std::uint32_t> _indices;
+};
+
+// Hands out one shared mesh per distinct set of parameters. The cache only holds weak
+// references, so a mesh is freed together with the last object that uses it.
+class MeshLibrary
+{
+public:
+    static MeshHandle cube(float size)
+    {
+        return cached(Kind::Cube, size, 0, [size]
+        {
+            MeshBuilder builder;
+            builder.addVertex({-size, -size, -size});
+            builder.addVertex({ size, -size, -size});
+            builder.addVertex({ size,  size, -size});
+            builder.addVertex({-size,  size, -size});
+            builder.addVertex({-size, -size,  size});
+            builder.addVertex({ size, -size,  size});
+            builder.addVertex({ size,  size,  size});
+            builder.addVertex({-size,  size,  size});
+
+            builder.addQuad(3, 2, 1, 0);
+            builder.addQuad(2, 6, 5, 1);
+            builder.addQuad(6, 7, 4, 5);
+            builder.addQuad(7, 3, 0, 4);
+            builder.addQuad(0, 1, 5, 4);
+            builder.addQuad(7, 6, 2, 3);
+            return builder.build();
+        });
+    }
+
+    static MeshHandle sphere(float radius, int segments)
+    {
+        return cached(Kind::Sphere, radius, segments, [radius, segments]
+        {
+            MeshBuilder builder;
+            for (int i = 0; i <= segments; ++i)
+            {
+                float lat = i * M_PI / segments - M_PI / 2;
+                float sinLat = std::sin(lat);
+                float cosLat = std::cos(lat);
+
+                for (int j = 0; j <= segments; ++j)
+                {
+                    float lon = j * 2 * M_PI / segments;
+                    float sinLon = std::sin(lon);
+                    float cosLon = std::cos(lon);
+
+                    builder.addVertex({radius * cosLat * cosLon, radius * sinLat, radius * cosLat * sinLon});
+                }
+            }
+
+            for (int i = 0; i < segments; ++i)
+            {
+                for (int j = 0; j < segments; ++j)
+                {
+                    std::uint32_t i0 = i * (segments + 1) + j;
+                    std::uint32_t i1 = i0 + 1;
+                    std::uint32_t i2 = (i + 1) * (segments + 1) + j;
+                    std::uint32_t i3 = i2 + 1;
+
+                    builder.addQuad(i0, i2, i3, i1);
+                }
+            }
+            return builder.build();
+        });
+    }
+
+    // Cuts the tessellation by a third per level down to MIN_SPHERE_SEGMENTS. A level is kept up to
+    // the screen radius at which its edges grow past SPHERE_EDGE_PIXELS.
+    static LodHandle sphereLods(float radius, int segments)
+    {
+        static std::map<std::pair<float, int>, std::weak_ptr<const LodChain>> cache;
+
+        auto &entry = cache[std::make_pair(radius, segments)];
+        LodHandle chain = entry.lock();
+        if (!chain)
+        {
+            auto lods = std::make_shared<LodChain>();
+            int levelSegments = segments;
+            while (true)
+            {
+                lods->levels.push_back(sphere(radius, levelSegments));
+                lods->maxScreenRadius.push_back(levelSegments * SPHERE_EDGE_PIXELS / (2.0f * static_cast<float>(M_PI)));
+                if (levelSegments <= MIN_SPHERE_SEGMENTS)
+                {
+                    break;
+                }
+                levelSegments = std::max(levelSegments * 2 / 3, static_cast<int>(MIN_SPHERE_SEGMENTS));
+            }
+            chain = lods;
+            entry = chain;
+        }
+        return chain;
+    }
+
+    static MeshHandle pyramid(float size)
+    {
+        return cached(Kind::Pyramid, size, 0, [size]
+        {
+            MeshBuilder builder;
+            builder.addVertex({-size, -size, -size});
+            builder.addVertex({ size, -size, -size});
+            builder.addVertex({ size, -size,  size});
+            builder.addVertex({-size, -size,  size});
+            builder.addVertex({0.0f,  size, 0.0f});
+
+            builder.addTriangle(0, 4, 1);
+            builder.addTriangle(1, 4, 2);
+            builder.addTriangle(2, 4, 3);
+            builder.addTriangle(3, 4, 0);
+            builder.addQuad(0, 1, 2, 3);
+            return builder.build();
+        });
+    }
+
+private:
+    static constexpr int MIN_SPHERE_SEGMENTS = 6;
+    static constexpr float SPHERE_EDGE_PIXELS = 8.0f;
+
+    enum class Kind { Cube, Sphere, Pyramid };
+    using Key = std::tuple<Kind, float, int>;
+
+    template<typename Build>
+    static MeshHandle cached(Kind kind, float size, int segments, Build &&build)
+    {
+        static std::map<Key, std::weak_ptr<const Mesh>> cache;
+
+        auto &entry = cache[Key(kind, size, segments)];
+        MeshHandle mesh = entry.lock();
+        if (!mesh)
+        {
+            mesh = build();
+            entry = mesh;
+        }
+        return mesh;
+    }
+};
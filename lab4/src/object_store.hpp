@@ -0,0 +1,118 @@
+#pragma once
+
+#include <SFML/System/Vector3.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "mesh.hpp"
+
+using ObjectId = std::uint32_t;
+
+enum MaterialFlags: std::uint32_t
+{
+    MATERIAL_NONE = 0,
+    MATERIAL_DOUBLE_SIDED = 1u << 0,
+    MATERIAL_HIDDEN = 1u << 1
+};
+
+// Every object in the scene as parallel arrays indexed by ObjectId. Each stage of the
+// frame walks only the arrays it needs, front to back, instead of chasing one heap
+// allocated object and its vtable per object. Meshes are referenced by index into a
+// small table of distinct LOD chains rather than by a shared_ptr per object.
+struct ObjectStore
+{
+    std::vector<float> positionX, positionY, positionZ;
+    std::vector<float> angleX, angleY;
+    std::vector<float> spinX, spinY;
+    std::vector<std::uint32_t> meshes;
+    std::vector<std::uint8_t> lods;
+    std::vector<std::uint32_t> materials;
+
+    std::vector<LodHandle> chains;
+
+    std::size_t size() const noexcept
+    {
+        return positionX.size();
+    }
+
+    ObjectId add(const LodHandle &chain, const sf::Vector3f &position, std::uint32_t material = MATERIAL_NONE)
+    {
+        positionX.push_back(position.x);
+        positionY.push_back(position.y);
+        positionZ.push_back(position.z);
+        angleX.push_back(0.0f);
+        angleY.push_back(0.0f);
+        spinX.push_back(0.0f);
+        spinY.push_back(0.0f);
+        meshes.push_back(chainIndex(chain));
+        lods.push_back(0);
+        materials.push_back(material);
+        return static_cast<ObjectId>(size() - 1);
+    }
+
+    ObjectId addCube(float size, const sf::Vector3f &position)
+    {
+        return add(LodChain::single(MeshLibrary::cube(size)), position);
+    }
+
+    ObjectId addSphere(float radius, int segments, const sf::Vector3f &position)
+    {
+        return add(MeshLibrary::sphereLods(radius, segments), position);
+    }
+
+    ObjectId addPyramid(float size, const sf::Vector3f &position)
+    {
+        return add(LodChain::single(MeshLibrary::pyramid(size)), position);
+    }
+
+    sf::Vector3f position(ObjectId id) const noexcept
+    {
+        return {positionX[id], positionY[id], positionZ[id]};
+    }
+
+    void setPosition(ObjectId id, const sf::Vector3f &position) noexcept
+    {
+        positionX[id] = position.x;
+        positionY[id] = position.y;
+        positionZ[id] = position.z;
+    }
+
+    void setRotation(ObjectId id, float x, float y) noexcept
+    {
+        angleX[id] = x;
+        angleY[id] = y;
+    }
+
+    // Angular velocity in radians per second, applied by the rotate stage.
+    void setSpin(ObjectId id, float x, float y) noexcept
+    {
+        spinX[id] = x;
+        spinY[id] = y;
+    }
+
+    const LodChain &chain(ObjectId id) const noexcept
+    {
+        return *chains[meshes[id]];
+    }
+
+    const Mesh &mesh(ObjectId id) const noexcept
+    {
+        return *chain(id).levels[lods[id]];
+    }
+
+private:
+    // LodChain::single makes a fresh chain per call, so single-level chains are matched by
+    // their mesh; multi-level chains come from the MeshLibrary cache and match by pointer.
+    std::uint32_t chainIndex(const LodHandle &chain)
+    {
+        for (std::size_t i = 0; i < chains.size(); ++i)
+        {
+            if (chains[i] == chain || (chains[i]->levels.size() == 1 && chain->levels.size() == 1 && chains[i]->levels[0] == chain->levels[0]))
+            {
+                return static_cast<std::uint32_t>(i);
+            }
+        }
+        chains.push_back(chain);
+        return static_cast<std::uint32_t>(chains.size() - 1);
+    }
+};
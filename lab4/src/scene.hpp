@@ -0,0 +1,325 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "face_queue.hpp"
+#include "job_system.hpp"
+#include "light_textures.hpp"
+#include "lighting.hpp"
+#include "object_store.hpp"
+#include "profiler.hpp"
+#include "systems.hpp"
+#include "transform.hpp"
+
+// Primitive counts for one frame. Faces of frustum-culled objects are counted as
+// frustum-culled faces without ever being transformed. verticesTransformed and
+// facesTransformed total the level of detail actually selected for each visible object.
+struct FrameStats
+{
+    std::size_t objectsSubmitted = 0;
+    std::size_t objectsFrustumCulled = 0;
+    std::size_t verticesTransformed = 0;
+    std::size_t facesTransformed = 0;
+    std::size_t facesSubmitted = 0;
+    std::size_t drawCalls = 0;
+    std::size_t facesFrustumCulled = 0;
+    std::size_t facesBackfaceCulled = 0;
+    std::size_t lightsBinned = 0;
+    std::size_t lightIndices = 0;
+    std::size_t clustersOccupied = 0;
+    std::size_t maxLightsPerCluster = 0;
+};
+
+struct Plane
+{
+    float a, b, c, d;
+
+    float distance(const sf::Vector3f &point) const noexcept
+    {
+        return a * point.x + b * point.y + c * point.z + d;
+    }
+};
+
+struct Frustum
+{
+    std::array<Plane, 5> planes;
+
+    // Extracts the side and near planes from a view-projection matrix built on
+    // Matrix4::projection: a point is on screen when 0 <= x <= width * w and
+    // 0 <= y <= height * w, and in front of the eye when w >= nearDistance.
+    static Frustum fromViewProjection(const Matrix4 &viewProjection, int screenWidth, int screenHeight, float nearDistance) noexcept
+    {
+        const float *m = viewProjection.m;
+        auto row = [m](int index, float scale, int otherIndex, float otherScale, float offset)
+        {
+            return Plane{
+                scale * m[index * 4 + 0] + otherScale * m[otherIndex * 4 + 0],
+                scale * m[index * 4 + 1] + otherScale * m[otherIndex * 4 + 1],
+                scale * m[index * 4 + 2] + otherScale * m[otherIndex * 4 + 2],
+                scale * m[index * 4 + 3] + otherScale * m[otherIndex * 4 + 3] + offset
+            };
+        };
+
+        Frustum frustum;
+        frustum.planes[0] = row(0, 1.0f, 3, 0.0f, 0.0f);
+        frustum.planes[1] = row(0, -1.0f, 3, static_cast<float>(screenWidth), 0.0f);
+        frustum.planes[2] = row(1, 1.0f, 3, 0.0f, 0.0f);
+        frustum.planes[3] = row(1, -1.0f, 3, static_cast<float>(screenHeight), 0.0f);
+        frustum.planes[4] = row(3, 1.0f, 3, 0.0f, -nearDistance);
+
+        for (auto &plane: frustum.planes)
+        {
+            float length = std::sqrt(plane.a * plane.a + plane.b * plane.b + plane.c * plane.c);
+            plane.a /= length;
+            plane.b /= length;
+            plane.c /= length;
+            plane.d /= length;
+        }
+
+        return frustum;
+    }
+
+    bool intersectsSphere(const sf::Vector3f &center, float radius) const noexcept
+    {
+        for (const auto &plane: planes)
+        {
+            if (plane.distance(center) < -radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+class Scene
+{
+public:
+    explicit Scene(std::size_t threadCount = std::max(1u, std::thread::hardware_concurrency())):
+        _jobs(threadCount)
+    {
+
+    }
+
+    ObjectStore &objects() noexcept
+    {
+        return _objects;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return _objects.size();
+    }
+
+    std::vector<PointLight> &lights() noexcept
+    {
+        return _lights;
+    }
+
+    std::size_t threadCount() const noexcept
+    {
+        return _jobs.threadCount();
+    }
+
+    // Rotate stage: advances every object by its spin, in parallel slices of the store.
+    void animate(float deltaSeconds)
+    {
+        PROFILE_ZONE("animate");
+        _jobs.parallelFor(_objects.size(), grainFor(_objects.size()), [this, deltaSeconds](std::size_t begin, std::size_t end)
+        {
+            rotateObjects(_objects, deltaSeconds, begin, end);
+        });
+    }
+
+    void draw(sf::RenderWindow &window, sf::Shader &shader, const sf::Vector3f &cameraPosition)
+    {
+        update(cameraPosition, window.getSize().x, window.getSize().y);
+        submit(window, shader, cameraPosition);
+    }
+
+    // Update phase: culls objects, selects levels of detail, transforms vertices and queues
+    // front-facing triangles (the CPU half of the draw stage), spreading the transform and
+    // face work across the job system, then bins the lights into clusters.
+    // Touches no window or shader state, so it can run ahead of submit().
+    void update(const sf::Vector3f &cameraPosition, int screenWidth, int screenHeight)
+    {
+        PROFILE_ZONE("update");
+        _stats = FrameStats();
+        _faceQueue.clear();
+        _visible.clear();
+        _chunks.clear();
+
+        Matrix4 view = Matrix4::translation({-cameraPosition.x, -cameraPosition.y, -cameraPosition.z});
+        Matrix4 viewProjection = Matrix4::projection(FOV, screenWidth, screenHeight) * view;
+        Frustum frustum = Frustum::fromViewProjection(viewProjection, screenWidth, screenHeight, NEAR_DISTANCE);
+
+        std::size_t vertexTotal = 0, faceTotal = 0;
+        {
+            PROFILE_ZONE("cull");
+            for (ObjectId id = 0; id < _objects.size(); ++id)
+            {
+                if (_objects.materials[id] & MATERIAL_HIDDEN)
+                {
+                    continue;
+                }
+
+                if (!frustum.intersectsSphere(_objects.position(id), _objects.mesh(id).boundingRadius))
+                {
+                    ++_stats.objectsFrustumCulled;
+                    _stats.facesFrustumCulled += _objects.mesh(id).triangleCount();
+                    continue;
+                }
+
+                selectLod(_objects, id, screenRadius(_objects, id, cameraPosition, screenWidth, screenHeight));
+
+                const Mesh &mesh = _objects.mesh(id);
+                for (std::size_t begin = 0; begin < mesh.vertexCount(); begin += VERTEX_CHUNK)
+                {
+                    _chunks.push_back({_visible.size(), begin, std::min(begin + VERTEX_CHUNK, mesh.vertexCount())});
+                }
+
+                _visible.push_back({id, vertexTotal, faceTotal, 0});
+                vertexTotal += mesh.vertexCount();
+                faceTotal += mesh.triangleCount();
+            }
+        }
+
+        _stats.objectsSubmitted = _visible.size();
+        _stats.verticesTransformed = vertexTotal;
+        _stats.facesTransformed = faceTotal;
+
+        _worldVertices.resize(vertexTotal);
+        _screenVertices.resize(vertexTotal);
+        _stagedFaces.resize(faceTotal);
+        _stagedDepths.resize(faceTotal);
+
+        // The job zones time each pass end to end on this thread; the transform, project
+        // and emit zones inside them are recorded by whichever thread ran the job.
+        {
+            PROFILE_ZONE("vertex jobs");
+            _jobs.parallelFor(_chunks.size(), grainFor(_chunks.size()), [this, &viewProjection](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    const VertexChunk &chunk = _chunks[i];
+                    const VisibleObject &visible = _visible[chunk.visibleIndex];
+                    transformObject(_objects, visible.id, viewProjection, chunk.begin, chunk.end, _worldVertices, _screenVertices, visible.vertexOffset);
+                }
+            });
+        }
+
+        {
+            PROFILE_ZONE("face jobs");
+            _jobs.parallelFor(_visible.size(), grainFor(_visible.size()), [this](std::size_t begin, std::size_t end)
+            {
+                PROFILE_ZONE("emit faces");
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    VisibleObject &visible = _visible[i];
+                    visible.faceCount = emitObjectFaces(_objects, visible.id, _worldVertices, _screenVertices, visible.vertexOffset,
+                                                        _stagedFaces.data() + visible.faceOffset, _stagedDepths.data() + visible.faceOffset);
+                }
+            });
+        }
+
+        {
+            PROFILE_ZONE("queue faces");
+            for (const auto &visible: _visible)
+            {
+                _faceQueue.append(_stagedFaces.data() + visible.faceOffset, _stagedDepths.data() + visible.faceOffset, visible.faceCount);
+            }
+            _stats.facesBackfaceCulled = faceTotal - _faceQueue.size();
+
+            _faceQueue.sort();
+        }
+
+        {
+            PROFILE_ZONE("light clusters");
+            _lightClusters.build(_lights, cameraPosition, screenWidth, screenHeight, NEAR_DISTANCE);
+        }
+        _stats.lightsBinned = _lightClusters.lights().size();
+        _stats.lightIndices = _lightClusters.indices().size();
+        _stats.clustersOccupied = _lightClusters.occupiedClusters();
+        _stats.maxLightsPerCluster = _lightClusters.maxLightsPerCluster();
+        _screenWidth = screenWidth;
+        _screenHeight = screenHeight;
+    }
+
+    // Submit phase: uploads uniforms and issues the draw calls. Must run on the thread that
+    // owns the window's GL context.
+    void submit(sf::RenderWindow &window, sf::Shader &shader, const sf::Vector3f &cameraPosition)
+    {
+        {
+            PROFILE_ZONE("uniforms");
+            _lightTextures.upload(_lightClusters);
+            _lightTextures.apply(shader, _lightClusters, _screenWidth, _screenHeight, NEAR_DISTANCE);
+        }
+        PROFILE_ZONE("window.draw");
+        _stats.drawCalls = _faceQueue.submit(window, shader, cameraPosition);
+        _stats.facesSubmitted = _faceQueue.size();
+    }
+
+    const FrameStats &stats() const noexcept
+    {
+        return _stats;
+    }
+
+    const FaceQueue &faceQueue() const noexcept
+    {
+        return _faceQueue;
+    }
+
+    const LightClusters &lightClusters() const noexcept
+    {
+        return _lightClusters;
+    }
+
+private:
+    static constexpr float NEAR_DISTANCE = 1.0f;
+    static constexpr std::size_t VERTEX_CHUNK = 4096;
+    static constexpr std::size_t JOBS_PER_THREAD = 8;
+
+    struct VisibleObject
+    {
+        ObjectId id;
+        std::size_t vertexOffset;
+        std::size_t faceOffset;
+        std::size_t faceCount;
+    };
+
+    struct VertexChunk
+    {
+        std::size_t visibleIndex;
+        std::size_t begin, end;
+    };
+
+    ObjectStore _objects;
+    JobSystem _jobs;
+    FrameStats _stats;
+    FaceQueue _faceQueue;
+    std::vector<PointLight> _lights;
+    LightClusters _lightClusters;
+    LightTextures _lightTextures;
+    int _screenWidth = 0;
+    int _screenHeight = 0;
+
+    std::vector<VisibleObject> _visible;
+    std::vector<VertexChunk> _chunks;
+    VertexStream _worldVertices;
+    VertexStream _screenVertices;
+    std::vector<QueuedFace> _stagedFaces;
+    std::vector<float> _stagedDepths;
+
+    // Enough jobs per thread for stealing to even out uneven meshes, without paying the
+    // queueing cost once per object when there are tens of thousands of them.
+    std::size_t grainFor(std::size_t count) const noexcept
+    {
+        return std::max<std::size_t>(1, count / (_jobs.threadCount() * JOBS_PER_THREAD));
+    }
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <SFML/System/Vector3.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "face_queue.hpp"
+#include "mesh.hpp"
+#include "object_store.hpp"
+#include "profiler.hpp"
+#include "transform.hpp"
+#include "vector_math.hpp"
+
+// Batch stages over an ObjectStore. Each takes a range or a single id so the scene can
+// hand slices of the store to different jobs.
+
+constexpr float FOV = 256.0f;
+constexpr float LOD_HYSTERESIS = 0.15f;
+
+// Rotate stage: advances every object in [begin, end) by its spin.
+inline void rotateObjects(ObjectStore &store, float deltaSeconds, std::size_t begin, std::size_t end) noexcept
+{
+    float *angleX = store.angleX.data();
+    float *angleY = store.angleY.data();
+    const float *spinX = store.spinX.data();
+    const float *spinY = store.spinY.data();
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        angleX[i] += spinX[i] * deltaSeconds;
+        angleY[i] += spinY[i] * deltaSeconds;
+    }
+}
+
+// Projected radius of the bounding sphere in pixels, using the larger of the two axis scales.
+inline float screenRadius(const ObjectStore &store, ObjectId id, const sf::Vector3f &cameraPosition, int screenWidth, int screenHeight) noexcept
+{
+    float aspectRatio = static_cast<float>(screenWidth) / screenHeight;
+    float w = store.positionZ[id] - cameraPosition.z + FOV;
+    return w > 0.0f ? store.mesh(id).boundingRadius * FOV * std::max(aspectRatio, 1.0f) / w : std::numeric_limits<float>::max();
+}
+
+// Picks the coarsest level that still looks smooth at this size. A level is only left
+// once the radius is LOD_HYSTERESIS past its boundary, so an object hovering at a
+// threshold does not flicker between two tessellations.
+inline void selectLod(ObjectStore &store, ObjectId id, float screenRadius) noexcept
+{
+    const auto &maxScreenRadius = store.chain(id).maxScreenRadius;
+    std::size_t lod = store.lods[id];
+    while (lod > 0 && screenRadius > maxScreenRadius[lod] * (1.0f + LOD_HYSTERESIS))
+    {
+        --lod;
+    }
+    while (lod + 1 < maxScreenRadius.size() && screenRadius < maxScreenRadius[lod + 1] * (1.0f - LOD_HYSTERESIS))
+    {
+        ++lod;
+    }
+    store.lods[id] = static_cast<std::uint8_t>(lod);
+}
+
+inline Matrix4 modelMatrix(const ObjectStore &store, ObjectId id) noexcept
+{
+    return Matrix4::translation(store.position(id)) * Matrix4::rotationY(store.angleY[id]) * Matrix4::rotationX(store.angleX[id]);
+}
+
+// Transform stage: vertices [begin, end) of the object's current level of detail into world
+// space and screen space. Mesh vertex i lands at index offset + i of both streams, so several
+// objects, or several chunks of one large mesh, can fill one shared frame buffer from
+// different threads.
+inline void transformObject(const ObjectStore &store, ObjectId id, const Matrix4 &viewProjection, std::size_t begin, std::size_t end,
+                            VertexStream &worldVertices, VertexStream &screenVertices, std::size_t offset) noexcept
+{
+    Matrix4 model = modelMatrix(store, id);
+    Matrix4 modelViewProjection = viewProjection * model;
+
+    const VertexStream &vertices = store.mesh(id).vertices;
+    std::size_t count = end - begin;
+    {
+        PROFILE_ZONE("transform");
+        transformPoints(model, vertices.x.data() + begin, vertices.y.data() + begin, vertices.z.data() + begin, count,
+                        worldVertices.x.data() + offset + begin, worldVertices.y.data() + offset + begin, worldVertices.z.data() + offset + begin);
+    }
+    PROFILE_ZONE("project");
+    projectPoints(modelViewProjection, vertices.x.data() + begin, vertices.y.data() + begin, vertices.z.data() + begin, count,
+                  screenVertices.x.data() + offset + begin, screenVertices.y.data() + offset + begin, screenVertices.z.data() + offset + begin);
+}
+
+// Outward-wound triangles that face the camera come out clockwise in screen space (y points
+// down), so a non-negative signed area means the triangle faces away or is edge-on.
+inline bool isBackFacing(const VertexStream &screenVertices, std::size_t a, std::size_t b, std::size_t c) noexcept
+{
+    float abX = screenVertices.x[b] - screenVertices.x[a];
+    float abY = screenVertices.y[b] - screenVertices.y[a];
+    float acX = screenVertices.x[c] - screenVertices.x[a];
+    float acY = screenVertices.y[c] - screenVertices.y[a];
+    return abX * acY - abY * acX >= 0.0f;
+}
+
+// Only feeds the shader's lighting, so the reciprocal square root estimate is enough.
+inline sf::Vector3f calculateNormal(const sf::Vector3f &v1, const sf::Vector3f &v2, const sf::Vector3f &v3)
+{
+    return cross(v2 - v1, v3 - v1).fastNormalize().as<sf::Vector3f>();
+}
+
+// Draw stage, CPU half: drops back-facing triangles of the transformed mesh (unless the
+// material is double sided) and writes the rest to faces and depths, which must hold the
+// mesh's triangle count. Returns the number written.
+inline std::size_t emitObjectFaces(const ObjectStore &store, ObjectId id, const VertexStream &worldVertices, const VertexStream &screenVertices,
+                                   std::size_t offset, QueuedFace *faces, float *depths)
+{
+    const auto &indices = store.mesh(id).indices;
+    bool cullBackFaces = (store.materials[id] & MATERIAL_DOUBLE_SIDED) == 0;
+    std::size_t emitted = 0;
+    for (std::size_t i = 0; i < indices.size(); i += 3)
+    {
+        std::size_t a = offset + indices[i];
+        std::size_t b = offset + indices[i + 1];
+        std::size_t c = offset + indices[i + 2];
+        if (cullBackFaces && isBackFacing(screenVertices, a, b, c))
+        {
+            continue;
+        }
+
+        QueuedFace &face = faces[emitted];
+        face.screen[0] = {screenVertices.x[a], screenVertices.y[a]};
+        face.screen[1] = {screenVertices.x[b], screenVertices.y[b]};
+        face.screen[2] = {screenVertices.x[c], screenVertices.y[c]};
+        face.normal = calculateNormal(worldVertices[a], worldVertices[b], worldVertices[c]);
+        face.position = worldVertices[a];
+
+        depths[emitted] = (screenVertices.z[a] + screenVertices.z[b] + screenVertices.z[c]) / 3.0f;
+        ++emitted;
+    }
+    return emitted;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <SFML/System/Vector3.hpp>
+#include <cstddef>
+#include <vector>
+
+#include "batch_math.hpp"
+#include "vector_math.hpp"
+
+// The lab's matrix is the shared row-major mat4; transformPoints and projectPoints on raw
+// arrays come from batch_math.hpp.
+using Matrix4 = mat4;
+
+// Structure-of-arrays vertex stream, laid out so the batch kernels can load
+// several consecutive x, y or z values with a single instruction.
+struct VertexStream
+{
+    std::vector<float> x, y, z;
+
+    VertexStream() = default;
+
+    explicit VertexStream(const std::vector<sf::Vector3f> &vertices)
+    {
+        resize(vertices.size());
+        for (std::size_t i = 0; i < vertices.size(); ++i)
+        {
+            x[i] = vertices[i].x;
+            y[i] = vertices[i].y;
+            z[i] = vertices[i].z;
+        }
+    }
+
+    std::size_t size() const noexcept
+    {
+        return x.size();
+    }
+
+    // No-op when the size already matches, so a stream reused every frame allocates once.
+    void resize(std::size_t count)
+    {
+        if (x.size() != count)
+        {
+            x.resize(count);
+            y.resize(count);
+            z.resize(count);
+        }
+    }
+
+    sf::Vector3f operator[](std::size_t i) const noexcept
+    {
+        return {x[i], y[i], z[i]};
+    }
+};
+
+inline void transformPoints(const Matrix4 &matrix, const VertexStream &in, VertexStream &out)
+{
+    out.resize(in.size());
+    transformPoints(matrix, in.x.data(), in.y.data(), in.z.data(), in.size(), out.x.data(), out.y.data(), out.z.data());
+}
+
+inline void projectPoints(const Matrix4 &matrix, const VertexStream &in, VertexStream &out)
+{
+    out.resize(in.size());
+    projectPoints(matrix, in.x.data(), in.y.data(), in.z.data(), in.size(), out.x.data(), out.y.data(), out.z.data());
+}
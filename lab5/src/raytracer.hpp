@@ -0,0 +1,200 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <cstdlib>
+
+#include "profiler.hpp"
+#include "vector_math.hpp"
+
+constexpr int WIDTH = 800;
+constexpr int HEIGHT = 600;
+
+// Colors, points and directions.
+using Vec3 = vec3;
+
+struct Sphere 
+{
+    Vec3 center;
+    float radius;
+    Vec3 color;
+
+    Sphere(const Vec3 &c, float r, const Vec3 &col): 
+        center(c), radius(r), color(col) 
+    {
+
+    }
+};
+
+struct Light 
+{
+    Vec3 position;
+    Vec3 color;
+
+    Light(const Vec3 &p, const Vec3 &c): 
+        position(p), color(c) 
+    {
+
+    }
+};
+
+struct Camera 
+{
+    Vec3 position;
+    Vec3 direction;
+    float aperture;
+    float focalLength;
+    int samples;
+
+    Camera(const Vec3 &pos, const Vec3 &dir, float ap, float fl, int s): 
+        position(pos), direction(dir), aperture(ap), focalLength(fl), samples(s) 
+    {
+
+    }
+};
+
+inline Vec3 randomInUnitDisk(float radius) 
+{
+    float theta = 2 * M_PI * (rand() / (float)RAND_MAX);
+    float r = radius * sqrt(rand() / (float)RAND_MAX);
+    return Vec3(r * cos(theta), r * sin(theta), 0);
+}
+
+inline Vec3 getRayDirection(const Camera &camera, float u, float v) 
+{
+    Vec3 rayDirection = Vec3(u, v, -1).normalize();
+    Vec3 focalPoint = camera.position + rayDirection * camera.focalLength;
+
+    Vec3 offset = randomInUnitDisk(camera.aperture);
+    Vec3 newOrigin = camera.position + offset;
+
+    return (focalPoint - newOrigin).normalize();
+}
+
+inline bool intersectSphere(const Vec3 &rayOrigin, const Vec3 &rayDirection, const Sphere &sphere, float &t) 
+{
+    Vec3 oc = rayOrigin - sphere.center;
+    float a = rayDirection.dot(rayDirection);
+    float b = 2.0f * oc.dot(rayDirection);
+    float c = oc.dot(oc) - sphere.radius * sphere.radius;
+    float discriminant = b * b - 4 * a * c;
+    if (discriminant < 0) return false;
+    t = (-b - sqrt(discriminant)) / (2.0f * a);
+    return t >= 0;
+}
+
+// The nearest sphere the ray hits and its distance in closestT, or nullptr.
+inline const Sphere *intersectScene(const Vec3 &rayOrigin, const Vec3 &rayDirection, const std::vector<Sphere> &spheres, float &closestT) 
+{
+    closestT = std::numeric_limits<float>::max();
+    const Sphere *closestSphere = nullptr;
+
+    for (const auto &sphere : spheres) 
+    {
+        float t;
+        if (intersectSphere(rayOrigin, rayDirection, sphere, t) && t < closestT) 
+        {
+            closestT = t;
+            closestSphere = &sphere;
+        }
+    }
+
+    return closestSphere;
+}
+
+inline Vec3 shadeHit(const Vec3 &rayOrigin, const Vec3 &rayDirection, const Sphere *closestSphere, float closestT, const std::vector<Light> &lights) 
+{
+    if (closestSphere) 
+    {
+        Vec3 hitPoint = rayOrigin + rayDirection * closestT;
+        Vec3 normal = (hitPoint - closestSphere->center).normalize();
+        Vec3 color = closestSphere->color;
+
+        Vec3 finalColor(0, 0, 0);
+        for (const auto &light : lights) 
+        {
+            Vec3 lightDir = (light.position - hitPoint).normalize();
+            float diffuse = std::max(normal.dot(lightDir), 0.0f);
+            finalColor = finalColor + color * diffuse;
+        }
+
+        return finalColor;
+    }
+
+    return Vec3(0, 0, 0);
+}
+
+inline Vec3 traceRay(const Vec3 &rayOrigin, const Vec3 &rayDirection, const std::vector<Sphere> &spheres, const std::vector<Light> &lights) 
+{
+    float closestT;
+    const Sphere *closestSphere = intersectScene(rayOrigin, rayDirection, spheres, closestT);
+    return shadeHit(rayOrigin, rayDirection, closestSphere, closestT, lights);
+}
+
+inline Vec3 traceRayWithDoF(const Vec3 &rayOrigin, const Vec3 &rayDirection, const std::vector<Sphere> &spheres, const std::vector<Light> &lights, const Camera &camera) 
+{
+    Vec3 color(0, 0, 0);
+
+    for (int i = 0; i < camera.samples; ++i) 
+    {
+        Vec3 sampleDirection = getRayDirection(camera, rayDirection.x, rayDirection.y);
+        color = color + traceRay(rayOrigin, sampleDirection, spheres, lights);
+    }
+
+    return color / camera.samples;
+}
+
+// Works a row at a time in three passes, so the profiler can time each stage: generate
+// every depth-of-field ray of the row, intersect them all, then shade and average them per
+// pixel. rand() is drawn in the same order as tracing pixel by pixel, and the image matches
+// traceRayWithDoF's.
+inline void renderScene(sf::Image &image, const std::vector<Sphere> &spheres, const std::vector<Light> &lights, const Camera &camera) 
+{
+    std::size_t samples = std::max(camera.samples, 0);
+    std::vector<Vec3> directions(WIDTH * samples);
+    std::vector<const Sphere *> hits(directions.size());
+    std::vector<float> distances(directions.size());
+
+    for (int y = 0; y < HEIGHT; ++y) 
+    {
+        {
+            PROFILE_ZONE("generate rays");
+            for (int x = 0; x < WIDTH; ++x) 
+            {
+                float u = (x + 0.5f) / WIDTH;
+                float v = (y + 0.5f) / HEIGHT;
+                Vec3 rayDirection = Vec3(u - 0.5f, v - 0.5f, -1).normalize();
+
+                for (std::size_t s = 0; s < samples; ++s) 
+                {
+                    directions[x * samples + s] = getRayDirection(camera, rayDirection.x, rayDirection.y);
+                }
+            }
+        }
+
+        {
+            PROFILE_ZONE("intersect");
+            for (std::size_t i = 0; i < directions.size(); ++i) 
+            {
+                hits[i] = intersectScene(camera.position, directions[i], spheres, distances[i]);
+            }
+        }
+
+        PROFILE_ZONE("shade");
+        for (int x = 0; x < WIDTH; ++x) 
+        {
+            Vec3 color(0, 0, 0);
+            for (std::size_t s = 0; s < samples; ++s) 
+            {
+                std::size_t i = x * samples + s;
+                color = color + shadeHit(camera.position, directions[i], hits[i], distances[i], lights);
+            }
+            color = color / camera.samples;
+
+            image.setPixel(x, y, sf::Color(color.x * 255, color.y * 255, color.z * 255));
+        }
+    }
+}